@@ -0,0 +1,356 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   wilton_chakra_bench.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 11:40 PM
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_engine.hpp"
+
+namespace { // anonymous
+
+using bench_clock = std::chrono::steady_clock;
+
+// callbacks are dispatched to 'WILTON_bench' functions
+const std::string init_code = std::string() +
+        "var WILTON_bench = {\n" +
+        "    echo: function(str) { return str; },\n" +
+        "    prepare: function(size) {\n" +
+        "        var str = 'abcdefghijklmnop';\n" +
+        "        while (str.length < size) { str = str + str; }\n" +
+        "        WILTON_bench.payload = str.substring(0, size);\n" +
+        "        return '';\n" +
+        "    },\n" +
+        "    roundtrip: function(count) {\n" +
+        "        var payload = WILTON_bench.payload;\n" +
+        "        for (var i = 0; i < count; i++) {\n" +
+        "            var res = WILTON_wiltoncall('bench_echo', payload);\n" +
+        "            if (res.length !== payload.length) { throw new Error('Invalid echo length'); }\n" +
+        "        }\n" +
+        "        return '';\n" +
+        "    },\n" +
+        "    load: function(url) { WILTON_load(url); return ''; },\n" +
+        "    garbage: function(count) {\n" +
+        "        var list = [];\n" +
+        "        for (var i = 0; i < count; i++) { list.push({ id: i, name: 'item' + i, pair: [i, i + 1] }); }\n" +
+        "        WILTON_bench.garbage = list;\n" +
+        "        return '';\n" +
+        "    },\n" +
+        "    release: function() { WILTON_bench.garbage = null; return ''; }\n" +
+        "};\n" +
+        "function WILTON_run(json) {\n" +
+        "    var cb = JSON.parse(json);\n" +
+        "    var res = WILTON_bench[cb.func].apply(null, cb.args || []);\n" +
+        "    return null === res || undefined === res ? null : String(res);\n" +
+        "}\n";
+
+const std::string module_path = "wilton_chakra_bench_module.js";
+
+struct options {
+    uint32_t iterations = 10000;
+    uint32_t threads = 0;
+    std::string output;
+};
+
+uint64_t micros_since(bench_clock::time_point start) {
+    auto elapsed = bench_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+sl::json::value latency_json(std::vector<uint64_t>& samples) {
+    if (samples.empty()) {
+        return sl::json::value();
+    }
+    std::sort(samples.begin(), samples.end());
+    uint64_t total = 0;
+    for (auto sa : samples) {
+        total += sa;
+    }
+    auto at = [&samples](size_t percent) {
+        return samples[(samples.size() - 1) * percent / 100];
+    };
+    return {
+        { "count", static_cast<uint64_t>(samples.size()) },
+        { "totalMicros", total },
+        { "minMicros", samples.front() },
+        { "avgMicros", total / samples.size() },
+        { "p50Micros", at(50) },
+        { "p90Micros", at(90) },
+        { "p99Micros", at(99) },
+        { "maxMicros", samples.back() }
+    };
+}
+
+std::string callback(const std::string& func, std::vector<sl::json::value> args) {
+    auto json = sl::json::value({
+        { "module", "bench" },
+        { "func", func },
+        { "args", sl::json::value(std::move(args)) }
+    });
+    return json.dumps();
+}
+
+std::string callback(const std::string& func, sl::json::value arg) {
+    auto args = std::vector<sl::json::value>();
+    args.emplace_back(std::move(arg));
+    return callback(func, std::move(args));
+}
+
+void run(wilton::chakra::chakra_engine& engine, const std::string& cb) {
+    engine.run_callback_script({cb.data(), cb.length()});
+}
+
+std::unique_ptr<wilton::chakra::chakra_engine> create_engine() {
+    return sl::support::make_unique<wilton::chakra::chakra_engine>(
+            sl::io::span<const char>(init_code.c_str(), init_code.length()));
+}
+
+sl::json::value bench_init(const options& opts) {
+    auto count = (std::min)(opts.iterations, static_cast<uint32_t>(20));
+    auto samples = std::vector<uint64_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = bench_clock::now();
+        auto engine = create_engine();
+        samples.push_back(micros_since(start));
+    }
+    return latency_json(samples);
+}
+
+sl::json::value bench_callbacks(wilton::chakra::chakra_engine& engine, const options& opts) {
+    auto cb = callback("echo", sl::json::value("hello"));
+    // warmup
+    for (uint32_t i = 0; i < opts.iterations / 10; i++) {
+        run(engine, cb);
+    }
+    auto samples = std::vector<uint64_t>();
+    samples.reserve(opts.iterations);
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < opts.iterations; i++) {
+        auto call_start = bench_clock::now();
+        run(engine, cb);
+        samples.push_back(micros_since(call_start));
+    }
+    auto total = micros_since(start);
+    return {
+        { "callsPerSecond", total > 0 ? static_cast<uint64_t>(opts.iterations) * 1000000 / total : 0 },
+        { "latency", latency_json(samples) }
+    };
+}
+
+sl::json::value bench_wiltoncall(wilton::chakra::chakra_engine& engine, const options& opts) {
+    auto res = std::vector<sl::json::value>();
+    for (uint64_t size = 16; size <= (1 << 24); size <<= 4) {
+        run(engine, callback("prepare", sl::json::value(size)));
+        // same number of bytes is moved for each size
+        auto count = static_cast<uint32_t>((std::max)(static_cast<uint64_t>(1),
+                (std::min)(static_cast<uint64_t>(opts.iterations), (static_cast<uint64_t>(1) << 28) / size)));
+        auto cb = callback("roundtrip", sl::json::value(count));
+        auto start = bench_clock::now();
+        run(engine, cb);
+        auto total = micros_since(start);
+        res.emplace_back(sl::json::value({
+            { "payloadBytes", size },
+            { "count", count },
+            { "avgMicros", total / count },
+            { "megabytesPerSecond", total > 0 ? size * count * 2 / total : 0 }
+        }));
+    }
+    run(engine, callback("prepare", sl::json::value(0)));
+    return sl::json::value(std::move(res));
+}
+
+sl::json::value bench_load(wilton::chakra::chakra_engine& engine, const options& opts) {
+    {
+        std::ofstream stream(module_path, std::ios::binary);
+        stream << "(function() {\n";
+        for (int i = 0; i < 500; i++) {
+            auto num = sl::support::to_string(i);
+            stream << "    function fun" << num << "(a, b) { return { sum: a + b + " << num <<
+                    ", list: [a, b, '" << num << "'] }; }\n";
+        }
+        stream << "    WILTON_bench.loaded = (WILTON_bench.loaded || 0) + fun1(1, 2).sum;\n";
+        stream << "})();\n";
+    }
+    auto deferred = sl::support::defer([] () STATICLIB_NOEXCEPT {
+        std::remove(module_path.c_str());
+    });
+    auto cb = callback("load", sl::json::value("file://" + module_path));
+    auto count = (std::min)(opts.iterations, static_cast<uint32_t>(1000));
+    auto samples = std::vector<uint64_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = bench_clock::now();
+        run(engine, cb);
+        samples.push_back(micros_since(start));
+    }
+    return latency_json(samples);
+}
+
+sl::json::value bench_gc(wilton::chakra::chakra_engine& engine, const options& opts) {
+    auto count = (std::min)(opts.iterations, static_cast<uint32_t>(50));
+    auto garbage = callback("garbage", sl::json::value(100000));
+    auto release = callback("release", std::vector<sl::json::value>());
+    auto live = std::vector<uint64_t>();
+    auto dead = std::vector<uint64_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        run(engine, garbage);
+        // objects reachable
+        auto start_live = bench_clock::now();
+        engine.run_garbage_collector();
+        live.push_back(micros_since(start_live));
+        run(engine, release);
+        auto start_dead = bench_clock::now();
+        engine.run_garbage_collector();
+        dead.push_back(micros_since(start_dead));
+    }
+    return {
+        { "liveHeap", latency_json(live) },
+        { "afterRelease", latency_json(dead) }
+    };
+}
+
+sl::json::value bench_scaling(const options& opts) {
+    auto max_threads = opts.threads > 0 ? opts.threads : std::thread::hardware_concurrency();
+    max_threads = (std::max)(max_threads, static_cast<uint32_t>(1));
+    auto cb = callback("echo", sl::json::value("hello"));
+    auto res = std::vector<sl::json::value>();
+    for (uint32_t threads_count = 1; ; threads_count = (std::min)(threads_count * 2, max_threads)) {
+        // engines are created before the measurement
+        auto engines = std::vector<std::unique_ptr<wilton::chakra::chakra_engine>>();
+        for (uint32_t i = 0; i < threads_count; i++) {
+            engines.emplace_back(create_engine());
+        }
+        auto errors = std::vector<std::string>();
+        errors.resize(threads_count);
+        auto threads = std::vector<std::thread>();
+        auto start = bench_clock::now();
+        for (uint32_t i = 0; i < threads_count; i++) {
+            auto engine_ptr = engines[i].get();
+            auto error_ptr = std::addressof(errors[i]);
+            auto iterations = opts.iterations;
+            threads.emplace_back([engine_ptr, error_ptr, iterations, &cb] {
+                try {
+                    for (uint32_t j = 0; j < iterations; j++) {
+                        run(*engine_ptr, cb);
+                    }
+                } catch (const std::exception& e) {
+                    *error_ptr = e.what();
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        auto total = micros_since(start);
+        for (auto& err : errors) {
+            if (!err.empty()) {
+                throw wilton::support::exception(TRACEMSG(err + "\nScaling run error"));
+            }
+        }
+        auto calls = static_cast<uint64_t>(opts.iterations) * threads_count;
+        res.emplace_back(sl::json::value({
+            { "threads", threads_count },
+            { "calls", calls },
+            { "callsPerSecond", total > 0 ? calls * 1000000 / total : 0 }
+        }));
+        if (threads_count == max_threads) {
+            break;
+        }
+    }
+    return sl::json::value(std::move(res));
+}
+
+options parse_options(int argc, char** argv) {
+    auto res = options();
+    for (int i = 1; i < argc; i++) {
+        auto arg = std::string(argv[i]);
+        if (i + 1 >= argc) {
+            throw wilton::support::exception(TRACEMSG("Missing value for option: [" + arg + "]"));
+        }
+        auto val = std::string(argv[i + 1]);
+        i += 1;
+        if ("--iterations" == arg) {
+            res.iterations = sl::utils::parse_uint32(val);
+        } else if ("--threads" == arg) {
+            res.threads = sl::utils::parse_uint32(val);
+        } else if ("--output" == arg) {
+            res.output = val;
+        } else {
+            throw wilton::support::exception(TRACEMSG("Unknown option: [" + arg + "]," +
+                    " usage: wilton_chakra_bench [--iterations N] [--threads N] [--output path.json]"));
+        }
+    }
+    if (0 == res.iterations) {
+        throw wilton::support::exception(TRACEMSG("Invalid iterations count: [0]"));
+    }
+    return res;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        auto opts = parse_options(argc, argv);
+        auto init = bench_init(opts);
+        auto engine = create_engine();
+        auto callbacks = bench_callbacks(*engine, opts);
+        auto wiltoncalls = bench_wiltoncall(*engine, opts);
+        auto load = bench_load(*engine, opts);
+        auto gc = bench_gc(*engine, opts);
+        engine.reset();
+        auto scaling = bench_scaling(opts);
+        auto res = sl::json::value({
+            { "iterations", opts.iterations },
+            { "engineInit", std::move(init) },
+            { "runCallbackScript", std::move(callbacks) },
+            { "wiltoncall", std::move(wiltoncalls) },
+            { "load", std::move(load) },
+            { "gc", std::move(gc) },
+            { "scaling", std::move(scaling) }
+        });
+        auto str = res.dumps();
+        if (opts.output.empty()) {
+            std::cout << str << std::endl;
+        } else {
+            std::ofstream stream(opts.output, std::ios::binary);
+            stream << str << std::endl;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << TRACEMSG(e.what() + "\nBenchmark error") << std::endl;
+        return 1;
+    }
+}
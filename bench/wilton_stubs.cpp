@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   wilton_stubs.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 11:20 PM
+ */
+
+// minimal implementations of the wilton_core, wilton_loader and
+// wilton_logging symbols used by the engine, so the benchmark
+// runs without the wilton runtime
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/utils.hpp"
+
+#include "wilton/wilton.h"
+#include "wilton/wiltoncall.h"
+#include "wilton/wilton_loader.h"
+#include "wilton/wilton_logging.h"
+
+#ifdef STATICLIB_WINDOWS
+#define WILTON_CHAKRA_BENCH_ENVIRON _environ
+#else // !STATICLIB_WINDOWS
+extern char** environ;
+#define WILTON_CHAKRA_BENCH_ENVIRON environ
+#endif // STATICLIB_WINDOWS
+
+namespace { // anonymous
+
+char* alloc_copy(const char* data, size_t len) {
+    auto res = wilton_alloc(static_cast<int>(len) + 1);
+    if (len > 0) {
+        std::memcpy(res, data, len);
+    }
+    res[len] = '\0';
+    return res;
+}
+
+char* alloc_copy(const std::string& str) {
+    return alloc_copy(str.data(), str.length());
+}
+
+} // namespace
+
+char* wilton_alloc(int size_bytes) {
+    return static_cast<char*>(std::malloc(static_cast<size_t>(size_bytes)));
+}
+
+void wilton_free(char* buffer) {
+    std::free(buffer);
+}
+
+// engine settings are passed through CHAKRA_* environment variables
+char* wilton_config(char** conf_json_out, int* conf_json_len_out) {
+    auto fields = std::vector<sl::json::field>();
+    for (char** en = WILTON_CHAKRA_BENCH_ENVIRON; nullptr != *en; en++) {
+        auto line = std::string(*en);
+        auto eq = line.find('=');
+        if (std::string::npos != eq && sl::utils::starts_with(line, "CHAKRA_")) {
+            fields.emplace_back(line.substr(0, eq), line.substr(eq + 1));
+        }
+    }
+    auto json = sl::json::value({
+        { "environmentVariables", sl::json::value(std::move(fields)) }
+    });
+    auto str = json.dumps();
+    *conf_json_out = alloc_copy(str);
+    *conf_json_len_out = static_cast<int>(str.length());
+    return nullptr;
+}
+
+// only 'bench_echo' is supported, it returns the copy of the input
+char* wiltoncall(const char* call_name, int call_name_len, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len) {
+    auto name = std::string(call_name, static_cast<size_t>(call_name_len));
+    if ("bench_echo" != name) {
+        return alloc_copy("Unknown call: [" + name + "]");
+    }
+    *json_out = alloc_copy(json_in, static_cast<size_t>(json_in_len));
+    *json_out_len = json_in_len;
+    return nullptr;
+}
+
+char* wilton_load_resource(const char* url, int url_len, char** contents_out, int* contents_out_len) {
+    auto path = std::string(url, static_cast<size_t>(url_len));
+    if (sl::utils::starts_with(path, "file://")) {
+        path = path.substr(7);
+    }
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) {
+        return alloc_copy("Cannot open resource: [" + path + "]");
+    }
+    auto contents = std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    *contents_out = alloc_copy(contents);
+    *contents_out_len = static_cast<int>(contents.length());
+    return nullptr;
+}
+
+// messages are dropped, debug level is reported as disabled
+char* wilton_logger_log(const char*, int, const char*, int, const char*, int) {
+    return nullptr;
+}
+
+char* wilton_logger_is_level_enabled(const char*, int, const char*, int, int* res_out) {
+    *res_out = 0;
+    return nullptr;
+}
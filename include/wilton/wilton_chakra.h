@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   wilton_chakra.h
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:10 PM
+ */
+
+#ifndef WILTON_CHAKRA_H
+#define WILTON_CHAKRA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* types of native function arguments and results */
+#define WILTON_CHAKRA_TYPE_UNDEFINED 0
+#define WILTON_CHAKRA_TYPE_NULL 1
+#define WILTON_CHAKRA_TYPE_BOOLEAN 2
+#define WILTON_CHAKRA_TYPE_NUMBER 3
+#define WILTON_CHAKRA_TYPE_STRING 4
+/* ArrayBuffer, TypedArray or DataView, supported only with ChakraCore */
+#define WILTON_CHAKRA_TYPE_BINARY 5
+
+/*
+ * Argument or result of a native function, 'data' is UTF-8 for strings;
+ * argument data is valid only for the duration of the call, result
+ * data must be allocated with 'wilton_alloc' and is owned by the engine
+ */
+typedef struct wilton_chakra_value {
+    int type;
+    int boolean_value;
+    double number_value;
+    char* data;
+    int data_len;
+} wilton_chakra_value;
+
+/*
+ * Native function, called on the engine thread; result is
+ * 'undefined' if not set; returned error must be allocated
+ * with 'wilton_alloc', it is thrown to JS as an Error
+ */
+typedef char* (*wilton_chakra_native_function)(
+        void* function_ctx,
+        const wilton_chakra_value* args,
+        int args_count,
+        wilton_chakra_value* result_out);
+
+/*
+ * Registers native function as a global in all contexts of all engines,
+ * existing engines install it before their next call; functions
+ * cannot be unregistered, context must stay valid until process exit;
+ * names of engine built-ins ('print', timer functions and any name
+ * starting with 'WILTON_') are rejected
+ */
+char* wilton_chakra_register_function(
+        const char* name,
+        int name_len,
+        void* function_ctx,
+        wilton_chakra_native_function function_cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WILTON_CHAKRA_H */
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_async.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 6:15 PM
+ */
+
+#include "chakra_async.hpp"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/wilton.h"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.async");
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex worker_pool_mutex;
+std::shared_ptr<chakra_worker_pool> worker_pool_instance;
+
+} // namespace
+
+chakra_completion_queue::~chakra_completion_queue() STATICLIB_NOEXCEPT {
+    // results that arrived after the engine was destroyed
+    for (auto& co : queue) {
+        if (nullptr != co.out) {
+            wilton_free(co.out);
+        }
+    }
+}
+
+void chakra_completion_queue::push(chakra_completion&& completion) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        queue.emplace_back(std::move(completion));
+    }
+    cv.notify_all();
+}
+
+void chakra_completion_queue::wake() {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        woken = true;
+    }
+    cv.notify_all();
+}
+
+bool chakra_completion_queue::wait_until(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> guard{mutex};
+    return cv.wait_until(guard, deadline, [this] {
+        return !this->queue.empty() || this->woken;
+    });
+}
+
+void chakra_completion_queue::wait() {
+    std::unique_lock<std::mutex> guard{mutex};
+    cv.wait(guard, [this] {
+        return !this->queue.empty() || this->woken;
+    });
+}
+
+void chakra_completion_queue::take_all(std::vector<chakra_completion>& dest) {
+    dest.clear();
+    std::lock_guard<std::mutex> guard{mutex};
+    dest.swap(queue);
+    // wake-up is consumed, work that caused it is checked after this call
+    woken = false;
+}
+
+chakra_worker_pool::chakra_worker_pool(uint32_t threads_count) {
+    auto count = threads_count > 0 ? threads_count : 1;
+    wilton::support::log_info(logger, "Starting async worker threads, count: [" +
+            sl::support::to_string(count) + "]");
+    for (uint32_t i = 0; i < count; i++) {
+        threads.emplace_back([this] {
+            this->run_worker();
+        });
+    }
+}
+
+chakra_worker_pool::~chakra_worker_pool() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
+void chakra_worker_pool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void chakra_worker_pool::run_worker() {
+    for (;;) {
+        auto task = std::function<void()>();
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            cv.wait(guard, [this] {
+                return this->stopping || !this->tasks.empty();
+            });
+            // queued tasks are finished before exit
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        try {
+            task();
+        } catch (const std::exception& e) {
+            wilton::support::log_error(logger, TRACEMSG(e.what() + "\nAsync task error"));
+        } catch (...) {
+            wilton::support::log_error(logger, TRACEMSG("Async task error"));
+        }
+    }
+}
+
+std::shared_ptr<chakra_worker_pool> shared_worker_pool(uint32_t threads_count) {
+    std::lock_guard<std::mutex> guard{worker_pool_mutex};
+    if (nullptr == worker_pool_instance.get()) {
+        worker_pool_instance = std::make_shared<chakra_worker_pool>(threads_count);
+    }
+    return worker_pool_instance;
+}
+
+} // namespace
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_async.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 6:00 PM
+ */
+
+#ifndef WILTON_CHAKRA_ASYNC_HPP
+#define WILTON_CHAKRA_ASYNC_HPP
+
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Result of a call performed on a worker thread,
+ * output is allocated by wiltoncall and is owned by the receiver
+ */
+struct chakra_completion {
+    uint64_t call_id = 0;
+    char* out = nullptr;
+    int out_len = 0;
+    std::string error;
+};
+
+/**
+ * Per-engine queue of finished async calls, filled by worker
+ * threads and drained by the thread that currently runs the engine
+ */
+class chakra_completion_queue {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<chakra_completion> queue;
+    bool woken = false;
+
+public:
+    chakra_completion_queue() { }
+
+    ~chakra_completion_queue() STATICLIB_NOEXCEPT;
+
+    chakra_completion_queue(const chakra_completion_queue&) = delete;
+
+    chakra_completion_queue& operator=(const chakra_completion_queue&) = delete;
+
+    void push(chakra_completion&& completion);
+
+    /**
+     * Wakes up the waiting thread without adding a completion,
+     * used when other work (channel messages) becomes available
+     */
+    void wake();
+
+    /**
+     * Waits until the queue becomes non-empty or the deadline is reached
+     *
+     * @param deadline max time to wait
+     * @return true if the queue is not empty or was woken up
+     */
+    bool wait_until(std::chrono::steady_clock::time_point deadline);
+
+    void wait();
+
+    /**
+     * Moves out all queued completions
+     *
+     * @param dest completions in the order they were pushed, previous contents are discarded
+     */
+    void take_all(std::vector<chakra_completion>& dest);
+};
+
+/**
+ * Fixed set of threads shared by all engines in the process
+ */
+class chakra_worker_pool {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+
+public:
+    chakra_worker_pool(uint32_t threads_count);
+
+    ~chakra_worker_pool() STATICLIB_NOEXCEPT;
+
+    chakra_worker_pool(const chakra_worker_pool&) = delete;
+
+    chakra_worker_pool& operator=(const chakra_worker_pool&) = delete;
+
+    void submit(std::function<void()> task);
+
+private:
+    void run_worker();
+};
+
+/**
+ * Returns process-wide worker pool, pool is created on first use
+ *
+ * @param threads_count number of threads, used only when pool is created
+ * @return worker pool
+ */
+std::shared_ptr<chakra_worker_pool> shared_worker_pool(uint32_t threads_count);
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_ASYNC_HPP */
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_batch.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 8:45 PM
+ */
+
+#include "chakra_batch.hpp"
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+class scanner {
+    const char* begin;
+    const char* end;
+    const char* pos;
+
+public:
+    scanner(sl::io::span<const char> json) :
+    begin(json.data()),
+    end(json.data() + json.size()),
+    pos(json.data()) { }
+
+    const char* position() const {
+        return pos;
+    }
+
+    void skip_whitespace() {
+        while (pos < end && (' ' == *pos || '\t' == *pos || '\n' == *pos || '\r' == *pos)) {
+            pos += 1;
+        }
+    }
+
+    bool at_end() const {
+        return pos >= end;
+    }
+
+    char peek() {
+        if (pos >= end) {
+            fail("Unexpected end of JSON");
+        }
+        return *pos;
+    }
+
+    void expect(char ch) {
+        if (ch != peek()) {
+            fail(std::string() + "Expected '" + ch + "'");
+        }
+        pos += 1;
+    }
+
+    void skip_string() {
+        expect('"');
+        for (; pos < end; pos++) {
+            if ('\\' == *pos) {
+                pos += 1;
+            } else if ('"' == *pos) {
+                pos += 1;
+                return;
+            }
+        }
+        fail("Unterminated JSON string");
+    }
+
+    // nested values are not parsed, only brackets are matched
+    void skip_value() {
+        auto ch = peek();
+        if ('"' == ch) {
+            skip_string();
+            return;
+        }
+        if ('{' == ch || '[' == ch) {
+            auto closers = std::string();
+            while (pos < end) {
+                auto cur = *pos;
+                if ('"' == cur) {
+                    skip_string();
+                    continue;
+                }
+                if ('{' == cur) {
+                    closers.push_back('}');
+                } else if ('[' == cur) {
+                    closers.push_back(']');
+                } else if ('}' == cur || ']' == cur) {
+                    if (closers.empty() || cur != closers.back()) {
+                        fail("Mismatched JSON bracket");
+                    }
+                    closers.pop_back();
+                    if (closers.empty()) {
+                        pos += 1;
+                        return;
+                    }
+                }
+                pos += 1;
+            }
+            fail("Unterminated JSON value");
+        }
+        // number, true, false or null
+        auto start = pos;
+        while (pos < end && ',' != *pos && '}' != *pos && ']' != *pos &&
+                ' ' != *pos && '\t' != *pos && '\n' != *pos && '\r' != *pos) {
+            pos += 1;
+        }
+        if (start == pos) {
+            fail("Invalid JSON value");
+        }
+    }
+
+    void fail(const std::string& msg) {
+        throw support::exception(TRACEMSG(msg + ", position: [" +
+                sl::support::to_string(pos - begin) + "]"));
+    }
+};
+
+std::string field_name(sl::io::span<const char> quoted) {
+    for (size_t i = 0; i < quoted.size(); i++) {
+        if ('\\' == quoted.data()[i]) {
+            // rare, escapes are decoded by the full parser
+            return sl::json::load(quoted).as_string();
+        }
+    }
+    return std::string(quoted.data() + 1, quoted.size() - 2);
+}
+
+const char* hex_symbols = "0123456789abcdef";
+
+} // namespace
+
+std::vector<std::pair<std::string, sl::io::span<const char>>> split_json_object(sl::io::span<const char> json) {
+    auto res = std::vector<std::pair<std::string, sl::io::span<const char>>>();
+    auto sc = scanner(json);
+    sc.skip_whitespace();
+    sc.expect('{');
+    sc.skip_whitespace();
+    if ('}' != sc.peek()) {
+        for (;;) {
+            sc.skip_whitespace();
+            auto name_start = sc.position();
+            sc.skip_string();
+            auto name = field_name({name_start, static_cast<size_t>(sc.position() - name_start)});
+            sc.skip_whitespace();
+            sc.expect(':');
+            sc.skip_whitespace();
+            auto val_start = sc.position();
+            sc.skip_value();
+            res.emplace_back(std::move(name), sl::io::span<const char>(val_start,
+                    static_cast<size_t>(sc.position() - val_start)));
+            sc.skip_whitespace();
+            if (',' != sc.peek()) {
+                break;
+            }
+            sc.expect(',');
+        }
+    }
+    sc.expect('}');
+    sc.skip_whitespace();
+    if (!sc.at_end()) {
+        sc.fail("Unexpected data after JSON object");
+    }
+    return res;
+}
+
+std::vector<sl::io::span<const char>> split_json_array(sl::io::span<const char> json) {
+    auto res = std::vector<sl::io::span<const char>>();
+    auto sc = scanner(json);
+    sc.skip_whitespace();
+    sc.expect('[');
+    sc.skip_whitespace();
+    if (']' != sc.peek()) {
+        for (;;) {
+            sc.skip_whitespace();
+            auto start = sc.position();
+            sc.skip_value();
+            res.emplace_back(start, static_cast<size_t>(sc.position() - start));
+            sc.skip_whitespace();
+            if (',' != sc.peek()) {
+                break;
+            }
+            sc.expect(',');
+        }
+    }
+    sc.expect(']');
+    sc.skip_whitespace();
+    if (!sc.at_end()) {
+        sc.fail("Unexpected data after JSON array");
+    }
+    return res;
+}
+
+void append_json_string(std::string& out, sl::io::span<const char> data) {
+    out.push_back('"');
+    for (size_t i = 0; i < data.size(); i++) {
+        auto ch = data.data()[i];
+        switch (ch) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                out.append("\\u00");
+                out.push_back(hex_symbols[(ch >> 4) & 0xf]);
+                out.push_back(hex_symbols[ch & 0xf]);
+            } else {
+                out.push_back(ch);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace
+}
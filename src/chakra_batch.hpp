@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_batch.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 8:40 PM
+ */
+
+#ifndef WILTON_CHAKRA_BATCH_HPP
+#define WILTON_CHAKRA_BATCH_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "staticlib/io.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Splits JSON object text into top-level fields without parsing
+ * field values, only strings and bracket nesting are checked
+ *
+ * @param json JSON object text
+ * @return field names and value texts pointing into the input
+ */
+std::vector<std::pair<std::string, sl::io::span<const char>>> split_json_object(sl::io::span<const char> json);
+
+/**
+ * Splits JSON array text into element texts without parsing
+ * elements, only strings and bracket nesting are checked
+ *
+ * @param json JSON array text
+ * @return element texts pointing into the input
+ */
+std::vector<sl::io::span<const char>> split_json_array(sl::io::span<const char> json);
+
+/**
+ * Appends the data to the JSON text as a quoted string,
+ * non-ASCII bytes are written as is
+ *
+ * @param out JSON text
+ * @param data string contents
+ */
+void append_json_string(std::string& out, sl::io::span<const char> data);
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_BATCH_HPP */
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_bytecode_cache.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 12:20 PM
+ */
+
+#include "chakra_bytecode_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.bytecode");
+
+const char entry_magic[] = "WCHKBC01";
+
+// makes temporary file names unique within the process
+std::atomic<uint64_t> tmp_counter(0);
+
+// all fields are stored in native byte order, cache
+// directory is not supposed to be shared between machines
+struct entry_header {
+    char magic[8];
+    uint64_t source_hash;
+    uint64_t source_len;
+    uint64_t bytecode_len;
+};
+
+std::string to_hex(uint64_t val) {
+    static const char* symbols = "0123456789abcdef";
+    auto res = std::string(16, '0');
+    for (size_t i = 0; i < res.length(); i++) {
+        res[res.length() - 1 - i] = symbols[val & 0xf];
+        val >>= 4;
+    }
+    return res;
+}
+
+bool header_matches(sl::io::span<const char> entry, size_t source_len, uint64_t source_hash) {
+    if (entry.size() < sizeof(entry_header)) {
+        return false;
+    }
+    auto header = entry_header();
+    std::memcpy(std::addressof(header), entry.data(), sizeof(header));
+    return 0 == std::memcmp(header.magic, entry_magic, sizeof(header.magic)) &&
+            header.source_len == source_len &&
+            header.bytecode_len == entry.size() - sizeof(entry_header) &&
+            header.source_hash == source_hash;
+}
+
+} // namespace
+
+chakra_bytecode_cache::chakra_bytecode_cache(const std::string& cache_dir) :
+dir(cache_dir.data(), cache_dir.length()) {
+    if (!dir.empty() && '/' != dir.back() && '\\' != dir.back()) {
+        dir.push_back('/');
+    }
+}
+
+std::shared_ptr<chakra_bytecode> chakra_bytecode_cache::load(const std::string& path,
+        size_t source_len, uint64_t source_hash) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = mapped.find(path);
+    if (mapped.end() != it) {
+        auto bc = it->second;
+        if (header_matches(bc->data_with_header(), source_len, source_hash)) {
+            return bc;
+        }
+        // source changed
+        mapped.erase(it);
+        return std::shared_ptr<chakra_bytecode>();
+    }
+    auto epath = entry_path(path);
+    auto file = std::shared_ptr<chakra_mapped_file>();
+    try {
+        file = std::make_shared<chakra_mapped_file>(epath);
+    } catch (const std::exception&) {
+        // not cached yet
+        return std::shared_ptr<chakra_bytecode>();
+    }
+    if (!header_matches(file->data(), source_len, source_hash)) {
+        wilton::support::log_debug(logger, "Stale bytecode entry, path: [" + path + "]");
+        return std::shared_ptr<chakra_bytecode>();
+    }
+    auto bc = std::make_shared<chakra_bytecode>(std::move(file), sizeof(entry_header));
+    mapped.insert(std::make_pair(path, bc));
+    return bc;
+}
+
+bool chakra_bytecode_cache::should_store(const std::string& path, uint64_t source_hash) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = failed.find(path);
+    return failed.end() == it || source_hash != it->second;
+}
+
+void chakra_bytecode_cache::store(const std::string& path, size_t source_len, uint64_t source_hash,
+        sl::io::span<const char> bytecode) {
+    auto epath = entry_path(path);
+    auto tid_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    auto tmp_path = epath + "." + to_hex(tid_hash) + "." +
+            sl::support::to_string(tmp_counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+    auto header = entry_header();
+    std::memcpy(header.magic, entry_magic, sizeof(header.magic));
+    header.source_hash = source_hash;
+    header.source_len = source_len;
+    header.bytecode_len = bytecode.size();
+
+    auto file = std::fopen(tmp_path.c_str(), "wb");
+    if (nullptr == file) {
+        wilton::support::log_warn(logger, "Cannot create bytecode entry, path: [" + tmp_path + "]");
+        store_failed(path, source_hash);
+        return;
+    }
+    auto written_header = std::fwrite(std::addressof(header), 1, sizeof(header), file);
+    auto written_bc = std::fwrite(bytecode.data(), 1, bytecode.size(), file);
+    auto err_close = std::fclose(file);
+    if (sizeof(header) != written_header || bytecode.size() != written_bc || 0 != err_close) {
+        std::remove(tmp_path.c_str());
+        wilton::support::log_warn(logger, "Error writing bytecode entry, path: [" + tmp_path + "]");
+        store_failed(path, source_hash);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard{mutex};
+    // rename cannot replace existing file on windows,
+    // removal fails there if the entry is mapped by this process
+    std::remove(epath.c_str());
+    if (0 != std::rename(tmp_path.c_str(), epath.c_str())) {
+        std::remove(tmp_path.c_str());
+        wilton::support::log_debug(logger, "Bytecode entry not replaced, path: [" + epath + "]");
+        failed[path] = source_hash;
+        return;
+    }
+    mapped.erase(path);
+    failed.erase(path);
+    wilton::support::log_debug(logger, "Bytecode entry written, script: [" + path + "]," +
+            " entry: [" + epath + "], size: [" + sl::support::to_string(bytecode.size()) + "]");
+}
+
+void chakra_bytecode_cache::invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> guard{mutex};
+    mapped.erase(path);
+    std::remove(entry_path(path).c_str());
+}
+
+uint64_t chakra_bytecode_cache::hash(sl::io::span<const char> data) {
+    // FNV-1a
+    uint64_t res = 14695981039346656037ULL;
+    for (size_t i = 0; i < data.size(); i++) {
+        res ^= static_cast<unsigned char>(data.data()[i]);
+        res *= 1099511628211ULL;
+    }
+    return res;
+}
+
+std::string chakra_bytecode_cache::entry_path(const std::string& path) {
+    auto span = sl::io::span<const char>(path.data(), path.length());
+    return dir + to_hex(hash(span)) + ".wbc";
+}
+
+void chakra_bytecode_cache::store_failed(const std::string& path, uint64_t source_hash) {
+    std::lock_guard<std::mutex> guard{mutex};
+    failed[path] = source_hash;
+}
+
+} // namespace
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_bytecode_cache.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 12:05 PM
+ */
+
+#ifndef WILTON_CHAKRA_BYTECODE_CACHE_HPP
+#define WILTON_CHAKRA_BYTECODE_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/io.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_mapped_file.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Serialized bytecode of a single script, data points either
+ * into the memory-mapped cache file or into an owned buffer
+ */
+class chakra_bytecode {
+    std::shared_ptr<chakra_mapped_file> file;
+    std::vector<char> owned;
+    size_t offset;
+
+public:
+    chakra_bytecode(std::shared_ptr<chakra_mapped_file> mapped_file, size_t data_offset) :
+    file(std::move(mapped_file)),
+    offset(data_offset) { }
+
+    chakra_bytecode(std::vector<char>&& bytecode) :
+    owned(std::move(bytecode)),
+    offset(0) { }
+
+    chakra_bytecode(const chakra_bytecode&) = delete;
+
+    chakra_bytecode& operator=(const chakra_bytecode&) = delete;
+
+    sl::io::span<const char> data() const {
+        auto span = data_with_header();
+        return {span.data() + offset, span.size() - offset};
+    }
+
+    sl::io::span<const char> data_with_header() const {
+        if (nullptr != file.get()) {
+            return file->data();
+        }
+        return {owned.data(), owned.size()};
+    }
+};
+
+/**
+ * Process-wide on-disk cache of serialized scripts, entries are
+ * keyed by the script path, source hash is stored in the entry header
+ * so changed sources invalidate the entry automatically
+ */
+class chakra_bytecode_cache {
+    std::string dir;
+    std::mutex mutex;
+    // mapped entries are shared between engines
+    std::unordered_map<std::string, std::shared_ptr<chakra_bytecode>> mapped;
+    // source hashes of entries that could not be written
+    std::unordered_map<std::string, uint64_t> failed;
+
+public:
+    chakra_bytecode_cache(const std::string& cache_dir);
+
+    chakra_bytecode_cache(const chakra_bytecode_cache&) = delete;
+
+    chakra_bytecode_cache& operator=(const chakra_bytecode_cache&) = delete;
+
+    /**
+     * Finds the bytecode for the specified source
+     *
+     * @param path script path
+     * @param source_len script source length
+     * @param source_hash script source hash
+     * @return bytecode or empty pointer if the entry is missing or stale
+     */
+    std::shared_ptr<chakra_bytecode> load(const std::string& path, size_t source_len, uint64_t source_hash);
+
+    /**
+     * Checks whether the entry for the specified source needs to be written,
+     * entries that failed to be written are not retried until source changes
+     *
+     * @param path script path
+     * @param source_hash script source hash
+     * @return false if writing this entry failed before
+     */
+    bool should_store(const std::string& path, uint64_t source_hash);
+
+    /**
+     * Writes bytecode entry for the specified source,
+     * IO errors are logged and remembered
+     *
+     * @param path script path
+     * @param source_len script source length
+     * @param source_hash script source hash
+     * @param bytecode serialized script
+     */
+    void store(const std::string& path, size_t source_len, uint64_t source_hash,
+            sl::io::span<const char> bytecode);
+
+    /**
+     * Drops in-memory entry, must be called when mapped bytecode
+     * is rejected by the engine
+     *
+     * @param path script path
+     */
+    void invalidate(const std::string& path);
+
+    static uint64_t hash(sl::io::span<const char> data);
+
+private:
+    std::string entry_path(const std::string& path);
+
+    void store_failed(const std::string& path, uint64_t source_hash);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_BYTECODE_CACHE_HPP */
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_callstats.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 10:45 PM
+ */
+
+#include "chakra_callstats.hpp"
+
+#include <vector>
+
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<chakra_callstats_shard>> registry;
+// stats of destroyed engines
+std::map<std::string, chakra_call_stats_snapshot> retired_wiltoncalls;
+std::map<std::string, chakra_call_stats_snapshot> retired_callbacks;
+
+size_t bucket_index(uint64_t micros) {
+    size_t idx = 0;
+    while (micros > 1 && idx < chakra_histogram::buckets_count - 1) {
+        micros >>= 1;
+        idx += 1;
+    }
+    return idx;
+}
+
+// single writer, plain load and store are enough and avoid locked instructions
+void increment(std::atomic<uint64_t>& counter, uint64_t val) {
+    counter.store(counter.load(std::memory_order_relaxed) + val, std::memory_order_relaxed);
+}
+
+chakra_call_stats& find_or_insert(std::mutex& mutex,
+        std::unordered_map<std::string, std::unique_ptr<chakra_call_stats>>& map, const std::string& name) {
+    auto it = map.find(name);
+    if (map.end() != it) {
+        return *it->second;
+    }
+    std::lock_guard<std::mutex> guard{mutex};
+    auto stats = sl::support::make_unique<chakra_call_stats>();
+    auto& res = *stats;
+    map.insert(std::make_pair(name, std::move(stats)));
+    return res;
+}
+
+void add_all(std::map<std::string, chakra_call_stats_snapshot>& dest,
+        const std::map<std::string, chakra_call_stats_snapshot>& src) {
+    for (auto& pa : src) {
+        dest[pa.first].add(pa.second);
+    }
+}
+
+sl::json::value to_json(const std::map<std::string, chakra_call_stats_snapshot>& map) {
+    auto fields = std::vector<sl::json::field>();
+    for (auto& pa : map) {
+        fields.emplace_back(pa.first, pa.second.to_json());
+    }
+    return sl::json::value(std::move(fields));
+}
+
+} // namespace
+
+chakra_histogram::chakra_histogram() :
+count(0),
+total_micros(0),
+max_micros(0) {
+    for (auto& bu : buckets) {
+        bu.store(0, std::memory_order_relaxed);
+    }
+}
+
+void chakra_histogram::record(uint64_t micros) {
+    increment(buckets[bucket_index(micros)], 1);
+    increment(count, 1);
+    increment(total_micros, micros);
+    if (micros > max_micros.load(std::memory_order_relaxed)) {
+        max_micros.store(micros, std::memory_order_relaxed);
+    }
+}
+
+chakra_histogram_snapshot::chakra_histogram_snapshot() {
+    buckets.fill(0);
+}
+
+void chakra_histogram_snapshot::add(const chakra_histogram& hist) {
+    for (size_t i = 0; i < buckets.size(); i++) {
+        buckets[i] += hist.buckets[i].load(std::memory_order_relaxed);
+    }
+    count += hist.count.load(std::memory_order_relaxed);
+    total_micros += hist.total_micros.load(std::memory_order_relaxed);
+    auto hist_max = hist.max_micros.load(std::memory_order_relaxed);
+    if (hist_max > max_micros) {
+        max_micros = hist_max;
+    }
+}
+
+void chakra_histogram_snapshot::add(const chakra_histogram_snapshot& other) {
+    for (size_t i = 0; i < buckets.size(); i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    total_micros += other.total_micros;
+    if (other.max_micros > max_micros) {
+        max_micros = other.max_micros;
+    }
+}
+
+bool chakra_histogram_snapshot::empty() const {
+    return 0 == count;
+}
+
+sl::json::value chakra_histogram_snapshot::to_json() const {
+    return {
+        { "count", count },
+        { "totalMicros", total_micros },
+        { "avgMicros", count > 0 ? total_micros / count : 0 },
+        { "maxMicros", max_micros },
+        { "p50Micros", percentile_upper_bound(50) },
+        { "p90Micros", percentile_upper_bound(90) },
+        { "p99Micros", percentile_upper_bound(99) }
+    };
+}
+
+// buckets are read without synchronization with the writer,
+// so sum of buckets may be slightly different from count
+uint64_t chakra_histogram_snapshot::percentile_upper_bound(uint64_t percent) const {
+    uint64_t sum = 0;
+    for (auto bu : buckets) {
+        sum += bu;
+    }
+    if (0 == sum) {
+        return 0;
+    }
+    auto target = (sum * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            auto bound = (static_cast<uint64_t>(1) << (i + 1)) - 1;
+            return bound < max_micros ? bound : max_micros;
+        }
+    }
+    return max_micros;
+}
+
+void chakra_call_stats_snapshot::add(const chakra_call_stats& stats) {
+    native.add(stats.native);
+    js.add(stats.js);
+    marshalling.add(stats.marshalling);
+}
+
+void chakra_call_stats_snapshot::add(const chakra_call_stats_snapshot& other) {
+    native.add(other.native);
+    js.add(other.js);
+    marshalling.add(other.marshalling);
+}
+
+sl::json::value chakra_call_stats_snapshot::to_json() const {
+    auto fields = std::vector<sl::json::field>();
+    if (!native.empty()) {
+        fields.emplace_back("native", native.to_json());
+    }
+    if (!js.empty()) {
+        fields.emplace_back("js", js.to_json());
+    }
+    if (!marshalling.empty()) {
+        fields.emplace_back("marshalling", marshalling.to_json());
+    }
+    return sl::json::value(std::move(fields));
+}
+
+chakra_call_stats& chakra_callstats_shard::wiltoncall(const std::string& name) {
+    return find_or_insert(mutex, wiltoncalls, name);
+}
+
+chakra_call_stats& chakra_callstats_shard::callback(const std::string& module) {
+    return find_or_insert(mutex, callbacks, module);
+}
+
+void chakra_callstats_shard::export_into(std::map<std::string, chakra_call_stats_snapshot>& wiltoncalls_dest,
+        std::map<std::string, chakra_call_stats_snapshot>& callbacks_dest) {
+    std::lock_guard<std::mutex> guard{mutex};
+    for (auto& pa : wiltoncalls) {
+        wiltoncalls_dest[pa.first].add(*pa.second);
+    }
+    for (auto& pa : callbacks) {
+        callbacks_dest[pa.first].add(*pa.second);
+    }
+}
+
+void register_callstats(std::shared_ptr<chakra_callstats_shard> shard) {
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    registry.emplace_back(std::move(shard));
+}
+
+void unregister_callstats(std::shared_ptr<chakra_callstats_shard> shard) {
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    for (auto it = registry.begin(); it != registry.end(); ++it) {
+        if (shard.get() == it->get()) {
+            shard->export_into(retired_wiltoncalls, retired_callbacks);
+            registry.erase(it);
+            break;
+        }
+    }
+}
+
+sl::json::value callstats_snapshot() {
+    auto wiltoncalls = std::map<std::string, chakra_call_stats_snapshot>();
+    auto callbacks = std::map<std::string, chakra_call_stats_snapshot>();
+    {
+        std::lock_guard<std::mutex> guard{registry_mutex};
+        add_all(wiltoncalls, retired_wiltoncalls);
+        add_all(callbacks, retired_callbacks);
+        for (auto& shard : registry) {
+            shard->export_into(wiltoncalls, callbacks);
+        }
+    }
+    return {
+        { "wiltoncalls", to_json(wiltoncalls) },
+        { "callbacks", to_json(callbacks) }
+    };
+}
+
+} // namespace
+}
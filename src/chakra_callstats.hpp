@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_callstats.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 10:30 PM
+ */
+
+#ifndef WILTON_CHAKRA_CALLSTATS_HPP
+#define WILTON_CHAKRA_CALLSTATS_HPP
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Latency histogram with power-of-two microsecond buckets, bucket N
+ * counts values in [2^N, 2^(N+1)); written by a single thread at a time
+ * without locking, may be read concurrently
+ */
+class chakra_histogram {
+public:
+    static const size_t buckets_count = 32;
+
+private:
+    std::array<std::atomic<uint64_t>, buckets_count> buckets;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total_micros;
+    std::atomic<uint64_t> max_micros;
+
+    friend class chakra_histogram_snapshot;
+
+public:
+    chakra_histogram();
+
+    chakra_histogram(const chakra_histogram&) = delete;
+
+    chakra_histogram& operator=(const chakra_histogram&) = delete;
+
+    void record(uint64_t micros);
+};
+
+/**
+ * Sum of histograms from multiple engines
+ */
+class chakra_histogram_snapshot {
+    std::array<uint64_t, chakra_histogram::buckets_count> buckets;
+    uint64_t count = 0;
+    uint64_t total_micros = 0;
+    uint64_t max_micros = 0;
+
+public:
+    chakra_histogram_snapshot();
+
+    void add(const chakra_histogram& hist);
+
+    void add(const chakra_histogram_snapshot& other);
+
+    bool empty() const;
+
+    sl::json::value to_json() const;
+
+private:
+    uint64_t percentile_upper_bound(uint64_t percent) const;
+};
+
+/**
+ * Timings of a single wiltoncall name or callback module
+ */
+struct chakra_call_stats {
+    // native call (wiltoncall) time
+    chakra_histogram native;
+    // JS execution time
+    chakra_histogram js;
+    // conversion of arguments and results between JS and native strings
+    chakra_histogram marshalling;
+};
+
+struct chakra_call_stats_snapshot {
+    chakra_histogram_snapshot native;
+    chakra_histogram_snapshot js;
+    chakra_histogram_snapshot marshalling;
+
+    void add(const chakra_call_stats& stats);
+
+    void add(const chakra_call_stats_snapshot& other);
+
+    // empty histograms are omitted
+    sl::json::value to_json() const;
+};
+
+/**
+ * Per-engine set of call stats, engine is used by one thread at a time,
+ * so lookups done by that thread need no locking; mutex guards
+ * insertions and exports
+ */
+class chakra_callstats_shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<chakra_call_stats>> wiltoncalls;
+    std::unordered_map<std::string, std::unique_ptr<chakra_call_stats>> callbacks;
+
+public:
+    chakra_callstats_shard() { }
+
+    chakra_callstats_shard(const chakra_callstats_shard&) = delete;
+
+    chakra_callstats_shard& operator=(const chakra_callstats_shard&) = delete;
+
+    /**
+     * Must be called only by the thread that currently runs the engine,
+     * returned reference stays valid for the lifetime of the shard
+     */
+    chakra_call_stats& wiltoncall(const std::string& name);
+
+    chakra_call_stats& callback(const std::string& module);
+
+    void export_into(std::map<std::string, chakra_call_stats_snapshot>& wiltoncalls_dest,
+            std::map<std::string, chakra_call_stats_snapshot>& callbacks_dest);
+};
+
+void register_callstats(std::shared_ptr<chakra_callstats_shard> shard);
+
+/**
+ * Removes shard from the registry, its stats are kept in the process totals
+ */
+void unregister_callstats(std::shared_ptr<chakra_callstats_shard> shard);
+
+/**
+ * Returns stats summed over all engines, including destroyed ones
+ *
+ * @return JSON object
+ */
+sl::json::value callstats_snapshot();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_CALLSTATS_HPP */
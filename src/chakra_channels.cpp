@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_channels.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 7:10 PM
+ */
+
+#include "chakra_channels.hpp"
+
+#include <algorithm>
+
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex registry_mutex;
+std::shared_ptr<chakra_channel_registry> registry_instance;
+
+uint64_t buffers_size(const chakra_message& msg) {
+    uint64_t res = 0;
+    for (auto& buf : msg.buffers) {
+        res += buf.size();
+    }
+    return res;
+}
+
+} // namespace
+
+chakra_mailbox::chakra_mailbox(std::shared_ptr<chakra_completion_queue> completion_queue,
+        uint32_t max_queued) :
+waker(std::move(completion_queue)),
+max_messages(max_queued) { }
+
+bool chakra_mailbox::push(chakra_message& msg) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (max_messages > 0 && queue.size() >= max_messages) {
+            return false;
+        }
+        queue.emplace_back(std::move(msg));
+    }
+    waker->wake();
+    return true;
+}
+
+void chakra_mailbox::take_all(std::vector<chakra_message>& dest) {
+    dest.clear();
+    std::lock_guard<std::mutex> guard{mutex};
+    dest.swap(queue);
+}
+
+size_t chakra_mailbox::size() {
+    std::lock_guard<std::mutex> guard{mutex};
+    return queue.size();
+}
+
+chakra_channel_registry::chakra_channel_registry() :
+transferred_bytes(0) { }
+
+void chakra_channel_registry::listen(const std::string& name, const std::shared_ptr<chakra_mailbox>& mailbox) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto& en = channels[name];
+    if (en.listeners.end() == std::find(en.listeners.begin(), en.listeners.end(), mailbox)) {
+        en.listeners.push_back(mailbox);
+    }
+}
+
+void chakra_channel_registry::unlisten(const std::string& name, const chakra_mailbox* mailbox) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = channels.find(name);
+    if (channels.end() == it) {
+        return;
+    }
+    auto& list = it->second.listeners;
+    list.erase(std::remove_if(list.begin(), list.end(),
+            [mailbox](const std::shared_ptr<chakra_mailbox>& mb) {
+                return mailbox == mb.get();
+            }), list.end());
+    if (list.empty()) {
+        channels.erase(it);
+    }
+}
+
+void chakra_channel_registry::unlisten_all(const chakra_mailbox* mailbox) STATICLIB_NOEXCEPT {
+    std::lock_guard<std::mutex> guard{mutex};
+    for (auto it = channels.begin(); it != channels.end();) {
+        auto& list = it->second.listeners;
+        list.erase(std::remove_if(list.begin(), list.end(),
+                [mailbox](const std::shared_ptr<chakra_mailbox>& mb) {
+                    return mailbox == mb.get();
+                }), list.end());
+        if (list.empty()) {
+            it = channels.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool chakra_channel_registry::post(chakra_message& msg) {
+    auto bytes = buffers_size(msg);
+    // mailbox lock is taken under the registry lock, mailboxes never call back
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = channels.find(msg.channel);
+    if (channels.end() == it) {
+        throw support::exception(TRACEMSG("Channel has no listeners, name: [" + msg.channel + "]"));
+    }
+    auto& en = it->second;
+    auto count = en.listeners.size();
+    for (size_t i = 0; i < count; i++) {
+        auto& mailbox = en.listeners[en.next % count];
+        en.next = (en.next + 1) % count;
+        if (mailbox->push(msg)) {
+            en.posted += 1;
+            transferred_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    en.rejected += 1;
+    return false;
+}
+
+sl::json::value chakra_channel_registry::stats() {
+    auto list = std::vector<sl::json::field>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (auto& en : channels) {
+            uint64_t queued = 0;
+            for (auto& mb : en.second.listeners) {
+                queued += mb->size();
+            }
+            list.emplace_back(en.first, sl::json::value({
+                { "listeners", static_cast<uint32_t>(en.second.listeners.size()) },
+                { "posted", en.second.posted },
+                { "rejected", en.second.rejected },
+                { "queuedInListenerMailboxes", queued }
+            }));
+        }
+    }
+    return {
+        { "transferredBytes", transferred_bytes.load(std::memory_order_relaxed) },
+        { "channels", std::move(list) }
+    };
+}
+
+chakra_channel_registry& channel_registry() {
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    if (nullptr == registry_instance.get()) {
+        registry_instance = std::make_shared<chakra_channel_registry>();
+    }
+    return *registry_instance;
+}
+
+} // namespace
+}
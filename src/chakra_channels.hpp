@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_channels.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 7:05 PM
+ */
+
+#ifndef WILTON_CHAKRA_CHANNELS_HPP
+#define WILTON_CHAKRA_CHANNELS_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_async.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Message sent between engines, buffers are the contents
+ * of the transferred ArrayBuffers, they are moved without copying
+ */
+struct chakra_message {
+    std::string channel;
+    sl::json::value data;
+    std::vector<std::vector<char>> buffers;
+};
+
+/**
+ * Per-engine queue of received messages, filled by the sending
+ * threads and drained by the event loop of the receiving engine
+ */
+class chakra_mailbox {
+    std::mutex mutex;
+    std::vector<chakra_message> queue;
+    std::shared_ptr<chakra_completion_queue> waker;
+    const uint32_t max_messages;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param waker completion queue of the engine, its event loop is woken up on push
+     * @param max_messages max number of queued messages, zero for unbounded
+     */
+    chakra_mailbox(std::shared_ptr<chakra_completion_queue> waker, uint32_t max_messages);
+
+    chakra_mailbox(const chakra_mailbox&) = delete;
+
+    chakra_mailbox& operator=(const chakra_mailbox&) = delete;
+
+    /**
+     * Adds message if there is space, message is moved only on success
+     *
+     * @param msg message
+     * @return false if mailbox is full
+     */
+    bool push(chakra_message& msg);
+
+    /**
+     * Moves out all queued messages
+     *
+     * @param dest messages in the order they were pushed, previous contents are discarded
+     */
+    void take_all(std::vector<chakra_message>& dest);
+
+    size_t size();
+};
+
+/**
+ * Named channels of the process, each channel has a list of engine mailboxes
+ * listening on it; message posted to a channel is delivered to a single
+ * listener, listeners are taken in turn, so a channel listened by multiple
+ * engines spreads the work between them
+ */
+class chakra_channel_registry {
+    struct channel_entry {
+        std::vector<std::shared_ptr<chakra_mailbox>> listeners;
+        size_t next = 0;
+        uint64_t posted = 0;
+        uint64_t rejected = 0;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, channel_entry> channels;
+    std::atomic<uint64_t> transferred_bytes;
+
+public:
+    chakra_channel_registry();
+
+    chakra_channel_registry(const chakra_channel_registry&) = delete;
+
+    chakra_channel_registry& operator=(const chakra_channel_registry&) = delete;
+
+    void listen(const std::string& name, const std::shared_ptr<chakra_mailbox>& mailbox);
+
+    void unlisten(const std::string& name, const chakra_mailbox* mailbox);
+
+    void unlisten_all(const chakra_mailbox* mailbox) STATICLIB_NOEXCEPT;
+
+    /**
+     * Delivers message to the next listener that has space in its mailbox,
+     * message is moved only on success
+     *
+     * @param msg message, its channel name is used for lookup
+     * @return false if mailboxes of all listeners are full
+     * @throws support::exception if channel has no listeners
+     */
+    bool post(chakra_message& msg);
+
+    sl::json::value stats();
+};
+
+chakra_channel_registry& channel_registry();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_CHANNELS_HPP */
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_config.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 12:30 AM
+ */
+
+#include "chakra_config.hpp"
+
+#include <mutex>
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex config_mutex;
+std::shared_ptr<chakra_config> config_instance;
+
+chakra_config load_config() {
+    char* conf = nullptr;
+    int conf_len = 0;
+    auto err = wilton_config(std::addressof(conf), std::addressof(conf_len));
+    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+    auto deferred = sl::support::defer([conf] () STATICLIB_NOEXCEPT {
+        wilton_free(conf);
+    });
+    auto json = sl::json::load({const_cast<const char*>(conf), conf_len});
+    return chakra_config(json["environmentVariables"]);
+}
+
+} // namespace
+
+chakra_config get_config() {
+    std::lock_guard<std::mutex> guard{config_mutex};
+    if (nullptr == config_instance.get()) {
+        config_instance = std::make_shared<chakra_config>(load_config());
+    }
+    return chakra_config(*config_instance);
+}
+
+} // namespace
+}
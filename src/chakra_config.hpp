@@ -25,19 +25,53 @@
 #define WILTON_CHAKRA_CONFIG_HPP
 
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
 
 #include "staticlib/json.hpp"
 #include "staticlib/support.hpp"
 #include "staticlib/utils.hpp"
 
+#include "wilton/wilton.h"
+
+#include "wilton/support/exception.hpp"
+
 namespace wilton {
 namespace chakra {
 
 class chakra_config {
 public:
     uint64_t runtime_memory_limit = 0;
+    uint64_t runtime_memory_soft_limit = 0;
     bool disable_background_work = false;
     bool disable_native_code_generation = false;
+    std::string bytecode_cache_dir;
+    uint32_t engine_pool_size = 0;
+    uint32_t engine_pool_borrow_timeout_millis = 30000;
+    uint32_t engine_pool_max_waiters = 0;
+    uint32_t max_named_contexts = 0;
+    uint32_t async_worker_threads = 4;
+    uint32_t event_loop_max_run_millis = 0;
+    bool enable_idle_processing = true;
+    uint32_t idle_gc_interval_millis = 0;
+    uint32_t idle_gc_min_idle_millis = 5000;
+    uint64_t idle_gc_min_growth_bytes = 1048576;
+    uint32_t call_timeout_millis = 0;
+    bool disable_eval = false;
+    bool enable_experimental_features = false;
+    bool disable_executable_page_allocation = false;
+    bool disable_fatal_on_oom = false;
+    std::string warmup_callback_script;
+    uint32_t warmup_iterations = 0;
+    uint32_t recycle_after_calls = 0;
+    uint64_t recycle_memory_growth_bytes = 0;
+    uint32_t recycle_max_age_millis = 0;
+    bool log_sink_enabled = false;
+    uint32_t log_sink_capacity = 4096;
+    bool log_sink_block_when_full = false;
+    uint32_t log_sink_flush_interval_millis = 10;
+    uint32_t channel_mailbox_capacity = 1024;
 
     chakra_config(const sl::json::value& env_json) {
         for (const sl::json::field& fi : env_json.as_object()) {
@@ -45,37 +79,196 @@ public:
             if (sl::utils::starts_with(name, "CHAKRA_")) {
                 if ("CHAKRA_RuntimeMemoryLimit" == name) {
                     this->runtime_memory_limit = str_as_u64(fi, name);
+                } else if ("CHAKRA_RuntimeMemorySoftLimit" == name) {
+                    this->runtime_memory_soft_limit = str_as_u64(fi, name);
                 } else if ("CHAKRA_DisableBackgroundWork" == name) {
                     this->disable_background_work = str_as_bool(fi, name);
                 } else if ("CHAKRA_DisableNativeCodeGeneration" == name) {
                     this->disable_native_code_generation = str_as_bool(fi, name);
+                } else if ("CHAKRA_BytecodeCacheDir" == name) {
+                    this->bytecode_cache_dir = fi.as_string_nonempty_or_throw(name);
+                } else if ("CHAKRA_EnginePoolSize" == name) {
+                    this->engine_pool_size = str_as_u32(fi, name);
+                } else if ("CHAKRA_EnginePoolBorrowTimeoutMillis" == name) {
+                    this->engine_pool_borrow_timeout_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_EnginePoolMaxWaiters" == name) {
+                    this->engine_pool_max_waiters = str_as_u32(fi, name);
+                } else if ("CHAKRA_MaxNamedContexts" == name) {
+                    this->max_named_contexts = str_as_u32(fi, name);
+                } else if ("CHAKRA_AsyncWorkerThreads" == name) {
+                    this->async_worker_threads = str_as_u32(fi, name);
+                } else if ("CHAKRA_EventLoopMaxRunMillis" == name) {
+                    this->event_loop_max_run_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_EnableIdleProcessing" == name) {
+                    this->enable_idle_processing = str_as_bool(fi, name);
+                } else if ("CHAKRA_IdleGcIntervalMillis" == name) {
+                    this->idle_gc_interval_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_IdleGcMinIdleMillis" == name) {
+                    this->idle_gc_min_idle_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_IdleGcMinGrowthBytes" == name) {
+                    this->idle_gc_min_growth_bytes = str_as_u64(fi, name);
+                } else if ("CHAKRA_CallTimeoutMillis" == name) {
+                    this->call_timeout_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_DisableEval" == name) {
+                    this->disable_eval = str_as_bool(fi, name);
+                } else if ("CHAKRA_EnableExperimentalFeatures" == name) {
+                    this->enable_experimental_features = str_as_bool(fi, name);
+                } else if ("CHAKRA_DisableExecutablePageAllocation" == name) {
+                    this->disable_executable_page_allocation = str_as_bool(fi, name);
+                } else if ("CHAKRA_DisableFatalOnOOM" == name) {
+                    this->disable_fatal_on_oom = str_as_bool(fi, name);
+                } else if ("CHAKRA_WarmupCallbackScript" == name) {
+                    this->warmup_callback_script = fi.as_string_nonempty_or_throw(name);
+                } else if ("CHAKRA_WarmupIterations" == name) {
+                    this->warmup_iterations = str_as_u32(fi, name);
+                } else if ("CHAKRA_RecycleAfterCalls" == name) {
+                    this->recycle_after_calls = str_as_u32(fi, name);
+                } else if ("CHAKRA_RecycleMemoryGrowthBytes" == name) {
+                    this->recycle_memory_growth_bytes = str_as_u64(fi, name);
+                } else if ("CHAKRA_RecycleMaxAgeMillis" == name) {
+                    this->recycle_max_age_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_LogSinkEnabled" == name) {
+                    this->log_sink_enabled = str_as_bool(fi, name);
+                } else if ("CHAKRA_LogSinkCapacity" == name) {
+                    this->log_sink_capacity = str_as_u32(fi, name);
+                } else if ("CHAKRA_LogSinkBlockWhenFull" == name) {
+                    this->log_sink_block_when_full = str_as_bool(fi, name);
+                } else if ("CHAKRA_LogSinkFlushIntervalMillis" == name) {
+                    this->log_sink_flush_interval_millis = str_as_u32(fi, name);
+                } else if ("CHAKRA_ChannelMailboxCapacity" == name) {
+                    this->channel_mailbox_capacity = str_as_u32(fi, name);
                 } else {
                     throw support::exception(TRACEMSG("Unknown 'chakra_config' field: [" + name + "]"));
                 }
             }
         }
+        validate();
     }
 
     chakra_config(const chakra_config& other) :
     runtime_memory_limit(other.runtime_memory_limit),
+    runtime_memory_soft_limit(other.runtime_memory_soft_limit),
     disable_background_work(other.disable_background_work),
-    disable_native_code_generation(other.disable_native_code_generation) { }
+    disable_native_code_generation(other.disable_native_code_generation),
+    bytecode_cache_dir(other.bytecode_cache_dir),
+    engine_pool_size(other.engine_pool_size),
+    engine_pool_borrow_timeout_millis(other.engine_pool_borrow_timeout_millis),
+    engine_pool_max_waiters(other.engine_pool_max_waiters),
+    max_named_contexts(other.max_named_contexts),
+    async_worker_threads(other.async_worker_threads),
+    event_loop_max_run_millis(other.event_loop_max_run_millis),
+    enable_idle_processing(other.enable_idle_processing),
+    idle_gc_interval_millis(other.idle_gc_interval_millis),
+    idle_gc_min_idle_millis(other.idle_gc_min_idle_millis),
+    idle_gc_min_growth_bytes(other.idle_gc_min_growth_bytes),
+    call_timeout_millis(other.call_timeout_millis),
+    disable_eval(other.disable_eval),
+    enable_experimental_features(other.enable_experimental_features),
+    disable_executable_page_allocation(other.disable_executable_page_allocation),
+    disable_fatal_on_oom(other.disable_fatal_on_oom),
+    warmup_callback_script(other.warmup_callback_script),
+    warmup_iterations(other.warmup_iterations),
+    recycle_after_calls(other.recycle_after_calls),
+    recycle_memory_growth_bytes(other.recycle_memory_growth_bytes),
+    recycle_max_age_millis(other.recycle_max_age_millis),
+    log_sink_enabled(other.log_sink_enabled),
+    log_sink_capacity(other.log_sink_capacity),
+    log_sink_block_when_full(other.log_sink_block_when_full),
+    log_sink_flush_interval_millis(other.log_sink_flush_interval_millis),
+    channel_mailbox_capacity(other.channel_mailbox_capacity) { }
 
     chakra_config& operator=(const chakra_config& other) {
         runtime_memory_limit = other.runtime_memory_limit;
+        runtime_memory_soft_limit = other.runtime_memory_soft_limit;
         disable_background_work = other.disable_background_work;
         disable_native_code_generation = other.disable_native_code_generation;
+        bytecode_cache_dir = other.bytecode_cache_dir;
+        engine_pool_size = other.engine_pool_size;
+        engine_pool_borrow_timeout_millis = other.engine_pool_borrow_timeout_millis;
+        engine_pool_max_waiters = other.engine_pool_max_waiters;
+        max_named_contexts = other.max_named_contexts;
+        async_worker_threads = other.async_worker_threads;
+        event_loop_max_run_millis = other.event_loop_max_run_millis;
+        enable_idle_processing = other.enable_idle_processing;
+        idle_gc_interval_millis = other.idle_gc_interval_millis;
+        idle_gc_min_idle_millis = other.idle_gc_min_idle_millis;
+        idle_gc_min_growth_bytes = other.idle_gc_min_growth_bytes;
+        call_timeout_millis = other.call_timeout_millis;
+        disable_eval = other.disable_eval;
+        enable_experimental_features = other.enable_experimental_features;
+        disable_executable_page_allocation = other.disable_executable_page_allocation;
+        disable_fatal_on_oom = other.disable_fatal_on_oom;
+        warmup_callback_script = other.warmup_callback_script;
+        warmup_iterations = other.warmup_iterations;
+        recycle_after_calls = other.recycle_after_calls;
+        recycle_memory_growth_bytes = other.recycle_memory_growth_bytes;
+        recycle_max_age_millis = other.recycle_max_age_millis;
+        log_sink_enabled = other.log_sink_enabled;
+        log_sink_capacity = other.log_sink_capacity;
+        log_sink_block_when_full = other.log_sink_block_when_full;
+        log_sink_flush_interval_millis = other.log_sink_flush_interval_millis;
+        channel_mailbox_capacity = other.channel_mailbox_capacity;
         return *this;
     }
 
     sl::json::value to_json() const {
         return {
             { "RuntimeMemoryLimit", runtime_memory_limit },
+            { "RuntimeMemorySoftLimit", runtime_memory_soft_limit },
             { "DisableBackgroundWork", disable_background_work },
-            { "DisableNativeCodeGeneration", disable_native_code_generation }
+            { "DisableNativeCodeGeneration", disable_native_code_generation },
+            { "BytecodeCacheDir", bytecode_cache_dir },
+            { "EnginePoolSize", engine_pool_size },
+            { "EnginePoolBorrowTimeoutMillis", engine_pool_borrow_timeout_millis },
+            { "EnginePoolMaxWaiters", engine_pool_max_waiters },
+            { "MaxNamedContexts", max_named_contexts },
+            { "AsyncWorkerThreads", async_worker_threads },
+            { "EventLoopMaxRunMillis", event_loop_max_run_millis },
+            { "EnableIdleProcessing", enable_idle_processing },
+            { "IdleGcIntervalMillis", idle_gc_interval_millis },
+            { "IdleGcMinIdleMillis", idle_gc_min_idle_millis },
+            { "IdleGcMinGrowthBytes", idle_gc_min_growth_bytes },
+            { "CallTimeoutMillis", call_timeout_millis },
+            { "DisableEval", disable_eval },
+            { "EnableExperimentalFeatures", enable_experimental_features },
+            { "DisableExecutablePageAllocation", disable_executable_page_allocation },
+            { "DisableFatalOnOOM", disable_fatal_on_oom },
+            { "WarmupCallbackScript", warmup_callback_script },
+            { "WarmupIterations", warmup_iterations },
+            { "RecycleAfterCalls", recycle_after_calls },
+            { "RecycleMemoryGrowthBytes", recycle_memory_growth_bytes },
+            { "RecycleMaxAgeMillis", recycle_max_age_millis },
+            { "LogSinkEnabled", log_sink_enabled },
+            { "LogSinkCapacity", log_sink_capacity },
+            { "LogSinkBlockWhenFull", log_sink_block_when_full },
+            { "LogSinkFlushIntervalMillis", log_sink_flush_interval_millis },
+            { "ChannelMailboxCapacity", channel_mailbox_capacity }
         };
     }
 private:
+    void validate() {
+#ifndef WILTON_CHAKRA_CHAKRACORE
+        if (disable_executable_page_allocation || disable_fatal_on_oom) {
+            throw support::exception(TRACEMSG("Parameters 'CHAKRA_DisableExecutablePageAllocation'" +
+                    " and 'CHAKRA_DisableFatalOnOOM' are supported only with ChakraCore"));
+        }
+#endif // !WILTON_CHAKRA_CHAKRACORE
+        if (warmup_iterations > 0 && warmup_callback_script.empty()) {
+            throw support::exception(TRACEMSG("Parameter 'CHAKRA_WarmupIterations' requires" +
+                    " 'CHAKRA_WarmupCallbackScript' to be specified"));
+        }
+        if (!warmup_callback_script.empty()) {
+            auto json = sl::json::load(warmup_callback_script);
+            if (sl::json::type::object != json.json_type()) {
+                throw support::exception(TRACEMSG("Invalid 'CHAKRA_WarmupCallbackScript'," +
+                        " callback script object expected, value: [" + warmup_callback_script + "]"));
+            }
+        }
+        if (log_sink_enabled && (0 == log_sink_capacity || 0 == log_sink_flush_interval_millis)) {
+            throw support::exception(TRACEMSG("Parameters 'CHAKRA_LogSinkCapacity'" +
+                    " and 'CHAKRA_LogSinkFlushIntervalMillis' must be positive"));
+        }
+    }
 
     static uint64_t str_as_u64(const sl::json::field& fi, const std::string& name) {
         auto str = fi.as_string_nonempty_or_throw(name);
@@ -87,6 +280,15 @@ private:
         }
     }
 
+    static uint32_t str_as_u32(const sl::json::field& fi, const std::string& name) {
+        auto val = str_as_u64(fi, name);
+        if (val > (std::numeric_limits<uint32_t>::max)()) {
+            throw support::exception(TRACEMSG("Error parsing parameter: [" + name + "]," +
+                    " value: [" + sl::support::to_string(val) + "] is out of range"));
+        }
+        return static_cast<uint32_t>(val);
+    }
+
     static bool str_as_bool(const sl::json::field& fi, const std::string& name) {
         auto str = fi.as_string_nonempty_or_throw(name);
         if ("true" == str) {
@@ -100,6 +302,14 @@ private:
     }
 };
 
+/**
+ * Returns engine settings, wilton config is parsed on the first call
+ * only, parsed settings are shared by all engines in the process
+ *
+ * @return copy of the settings
+ */
+chakra_config get_config();
+
 } // namespace
 }
 
@@ -24,11 +24,26 @@
 #include "chakra_engine.hpp"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include <jsrt.h>
+#include "staticlib/config.hpp"
+
+#ifndef STATICLIB_WINDOWS
+#include <time.h>
+#endif // !STATICLIB_WINDOWS
 
 #include "staticlib/io.hpp"
 #include "staticlib/json.hpp"
@@ -36,58 +51,694 @@
 #include "staticlib/support.hpp"
 #include "staticlib/utils.hpp"
 
+#include "wilton/wilton.h"
 #include "wilton/wiltoncall.h"
-#include "wilton/wilton_loader.h"
 
 #include "wilton/support/exception.hpp"
 #include "wilton/support/logging.hpp"
 
+#include "chakra_async.hpp"
+#include "chakra_batch.hpp"
+#include "chakra_bytecode_cache.hpp"
+#include "chakra_callstats.hpp"
+#include "chakra_channels.hpp"
 #include "chakra_config.hpp"
+#include "chakra_json.hpp"
+#include "chakra_log_sink.hpp"
+#include "chakra_jsrt.hpp"
+#include "chakra_logging.hpp"
+#include "chakra_memory.hpp"
+#include "chakra_native_registry.hpp"
+#include "chakra_profiler.hpp"
+#include "chakra_script_source.hpp"
+#include "chakra_shared_store.hpp"
+#include "chakra_watchdog.hpp"
 
 namespace wilton {
 namespace chakra {
 
 namespace { // anonymous
 
-chakra_config get_config() {
-    char* conf = nullptr;
-    int conf_len = 0;
-    auto err = wilton_config(std::addressof(conf), std::addressof(conf_len));
-    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
-    auto deferred = sl::support::defer([conf] () STATICLIB_NOEXCEPT {
-        wilton_free(conf);
-    });
-    auto json = sl::json::load({const_cast<const char*>(conf), conf_len});
-    return chakra_config(json["environmentVariables"]);
+// serialized scripts must stay valid until runtime is disposed
+struct serialized_script {
+    std::shared_ptr<chakra_bytecode> bytecode;
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    std::shared_ptr<chakra_script_source> source;
+#else // !WILTON_CHAKRA_CHAKRACORE
+    std::wstring source;
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+    serialized_script(std::shared_ptr<chakra_bytecode> bc, std::shared_ptr<chakra_script_source> src) :
+    bytecode(std::move(bc)) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+        source = std::move(src);
+#else // !WILTON_CHAKRA_CHAKRACORE
+        widen_into(src->data(), source);
+#endif // WILTON_CHAKRA_CHAKRACORE
+    }
+};
+
+// continuation enqueued by the engine, run in the context it was created in
+struct promise_job {
+    JsContextRef ctx;
+    JsValueRef task;
+};
+
+// in-flight async call, resolving functions are kept alive with JsAddRef
+struct pending_call {
+    JsContextRef ctx;
+    JsValueRef resolve;
+    JsValueRef reject;
+};
+
+// setTimeout and setImmediate callback with its arguments, all kept alive with JsAddRef
+struct timer_task {
+    JsContextRef ctx = JS_INVALID_REFERENCE;
+    JsValueRef callback = JS_INVALID_REFERENCE;
+    std::vector<JsValueRef> args;
+};
+
+struct timer_entry {
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t id;
+
+    // min-heap on deadline, timers with equal deadlines run in creation order
+    bool operator<(const timer_entry& other) const {
+        if (deadline != other.deadline) {
+            return deadline > other.deadline;
+        }
+        return id > other.id;
+    }
+};
+
+// per-name logging and timings for calls made from JS
+struct wiltoncall_site {
+    debug_log_gate log;
+    chakra_call_stats& stats;
+
+    wiltoncall_site(const std::string& name, chakra_call_stats& call_stats) :
+    log("wilton.wiltoncall." + name),
+    stats(call_stats) { }
+
+    wiltoncall_site(const wiltoncall_site&) = delete;
+
+    wiltoncall_site& operator=(const wiltoncall_site&) = delete;
+};
+
+struct engine_state;
+struct lazy_result;
+
+// callback state of a function registered by other module
+struct native_binding {
+    engine_state* state;
+    std::shared_ptr<const chakra_native_function> fun;
+
+    native_binding(engine_state* engine_st, std::shared_ptr<const chakra_native_function> native_fun) :
+    state(engine_st),
+    fun(std::move(native_fun)) { }
+
+    native_binding(const native_binding&) = delete;
+
+    native_binding& operator=(const native_binding&) = delete;
+};
+
+// channel listener, called with (data, buffers, channelName)
+struct channel_listener {
+    JsContextRef ctx = JS_INVALID_REFERENCE;
+    JsValueRef callback = JS_INVALID_REFERENCE;
+};
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+// storage of a buffer allocated for channels or received from one, moved
+// to a message on transfer, holder is deleted by the GC finalizer
+struct transfer_holder {
+    engine_state* state;
+    std::vector<char> data;
+
+    transfer_holder(engine_state* engine_st, std::vector<char>&& buf) :
+    state(engine_st),
+    data(std::move(buf)) { }
+
+    transfer_holder(const transfer_holder&) = delete;
+
+    transfer_holder& operator=(const transfer_holder&) = delete;
+};
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+// external buffer pointing to a shared store blob, kept alive with JsAddRef,
+// version is re-checked only after the store is changed
+struct shared_buffer {
+    uint64_t version = 0;
+    uint64_t checked_generation = 0;
+    JsValueRef buffer = JS_INVALID_REFERENCE;
+};
+
+// per-engine data, shared by all contexts of the runtime,
+// passed to native functions as a callback state
+struct engine_state {
+    // resolved once at init, kept alive with JsAddRef
+    JsPropertyIdRef stack_prop = JS_INVALID_REFERENCE;
+    JsPropertyIdRef wilton_run_prop = JS_INVALID_REFERENCE;
+
+    std::shared_ptr<chakra_bytecode_cache> bytecode_cache;
+    // one entry per bytecode, reused by repeated loads
+    std::unordered_map<const chakra_bytecode*, std::unique_ptr<serialized_script>> serialized_scripts;
+    // structured call arguments and results
+    chakra_json json;
+    // reused for all boundary crossings
+    string_buffer_pool buffers;
+    std::wstring wbuf;
+
+    // promise jobs and async calls are processed
+    // only when the outermost call returns
+    uint32_t call_depth = 0;
+    std::deque<promise_job> promise_jobs;
+    uint32_t async_worker_threads = 4;
+    uint64_t next_call_id = 0;
+    std::unordered_map<uint64_t, pending_call> pending_calls;
+    std::shared_ptr<chakra_completion_queue> completions = std::make_shared<chakra_completion_queue>();
+    std::vector<chakra_completion> completions_buf;
+
+    // timers and immediates, cancelled entries are
+    // removed from the map and skipped in the heap
+    uint64_t next_timer_id = 1;
+    std::unordered_map<uint64_t, timer_task> timers;
+    std::vector<timer_entry> timers_heap;
+    std::deque<uint64_t> immediates;
+    uint32_t event_loop_max_run_millis = 0;
+
+    // call timings, debug logging is checked through cached gates
+    std::shared_ptr<chakra_callstats_shard> callstats = std::make_shared<chakra_callstats_shard>();
+    std::unordered_map<std::string, std::unique_ptr<wiltoncall_site>> wiltoncall_sites;
+    debug_log_gate run_log = debug_log_gate("wilton.engine.chakra.run");
+    debug_log_gate eval_log = debug_log_gate("wilton.engine.chakra.eval");
+
+    // blobs published to the process-wide store
+    std::unordered_map<std::string, shared_buffer> shared_buffers;
+
+    // sampling profiler, runtime is in debug mode only while profiling is started
+    std::shared_ptr<chakra_profiler> profiler;
+    std::shared_ptr<chakra_profile_shard> profile;
+    uint64_t profiler_generation = 0;
+    JsPropertyIdRef length_prop = JS_INVALID_REFERENCE;
+    JsPropertyIdRef function_handle_prop = JS_INVALID_REFERENCE;
+    JsPropertyIdRef name_prop = JS_INVALID_REFERENCE;
+    JsPropertyIdRef file_name_prop = JS_INVALID_REFERENCE;
+
+    // live handles returned by 'WILTON_wiltoncall_lazy', removed by GC finalizers
+    std::unordered_set<lazy_result*> lazy_results;
+
+    // functions registered by other modules, installed in all contexts,
+    // registry is resolved once at init and is never destroyed
+    chakra_native_registry* natives = nullptr;
+    std::vector<std::unique_ptr<native_binding>> native_bindings;
+
+    // print output and debug logging, written by
+    // the background thread when the sink is enabled
+    std::shared_ptr<chakra_log_sink> log_sink;
+    std::shared_ptr<chakra_log_ring> log_ring;
+
+    // cross-engine messages, listener callbacks are kept alive with JsAddRef
+    std::shared_ptr<chakra_mailbox> mailbox;
+    std::unordered_map<std::string, channel_listener> channel_listeners;
+    std::vector<chakra_message> messages_buf;
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    // buffers that can be transferred without copying, keyed by storage pointer
+    std::unordered_map<const char*, transfer_holder*> transfer_buffers;
+#endif // WILTON_CHAKRA_CHAKRACORE
+};
+
+// message is built by the caller, formatting and I/O are done
+// by the sink thread, written inline when the sink is not enabled
+void engine_log(engine_state& st, chakra_log_kind kind, const std::string& logger, std::string&& msg) {
+    if (nullptr != st.log_ring.get()) {
+        auto rec = chakra_log_record();
+        rec.kind = kind;
+        if (chakra_log_kind::print != kind) {
+            rec.logger = logger;
+        }
+        rec.message = std::move(msg);
+        st.log_sink->push(*st.log_ring, std::move(rec));
+        return;
+    }
+    switch (kind) {
+    case chakra_log_kind::print:
+        puts(msg.c_str());
+        break;
+    case chakra_log_kind::debug:
+        wilton::support::log_debug(logger, msg);
+        break;
+    case chakra_log_kind::info:
+        wilton::support::log_info(logger, msg);
+        break;
+    case chakra_log_kind::warn:
+        wilton::support::log_warn(logger, msg);
+        break;
+    case chakra_log_kind::error:
+        wilton::support::log_error(logger, msg);
+        break;
+    }
+}
+
+void engine_print(engine_state& st, std::string&& msg) {
+    engine_log(st, chakra_log_kind::print, std::string(), std::move(msg));
+}
+
+void engine_log_debug(engine_state& st, const std::string& logger, std::string&& msg) {
+    engine_log(st, chakra_log_kind::debug, logger, std::move(msg));
 }
 
+void engine_log_info(engine_state& st, const std::string& logger, std::string&& msg) {
+    engine_log(st, chakra_log_kind::info, logger, std::move(msg));
+}
+
+void engine_log_warn(engine_state& st, const std::string& logger, std::string&& msg) {
+    engine_log(st, chakra_log_kind::warn, logger, std::move(msg));
+}
+
+// per-context data, each context has its own set of globals
+struct context_state {
+    std::string name;
+    JsContextRef ctx = JS_INVALID_REFERENCE;
+    // resolved once at init, kept alive with JsAddRef
+    JsValueRef global = JS_INVALID_REFERENCE;
+    JsValueRef null_value = JS_INVALID_REFERENCE;
+    // re-resolved when global binding is replaced
+    JsValueRef wilton_run_fun = JS_INVALID_REFERENCE;
+    size_t native_functions_installed = 0;
+
+    context_state(const std::string& context_name) :
+    name(context_name.data(), context_name.length()) { }
+};
+
+// engines may be moved between threads, so context
+// is made current only for the duration of the call
+class context_scope {
+    JsContextRef ctx;
+    JsContextRef prev = JS_INVALID_REFERENCE;
+
+public:
+    context_scope(JsContextRef context) :
+    ctx(context) {
+        auto err_get = JsGetCurrentContext(std::addressof(prev));
+        if (JsNoError != err_get) throw support::exception(TRACEMSG(
+                "'JsGetCurrentContext' error, code: [" + sl::support::to_string(err_get) + "]"));
+        if (prev != ctx) {
+            auto err_set = JsSetCurrentContext(ctx);
+            if (JsNoError != err_set) throw support::exception(TRACEMSG(
+                    "'JsSetCurrentContext' error, code: [" + sl::support::to_string(err_set) + "]"));
+        }
+    }
+
+    ~context_scope() STATICLIB_NOEXCEPT {
+        if (prev != ctx) {
+            JsSetCurrentContext(prev);
+        }
+    }
+
+    context_scope(const context_scope&) = delete;
+
+    context_scope& operator=(const context_scope&) = delete;
+};
+
 JsRuntimeAttributes create_attributes(chakra_config& cfg) {
-    auto res = JsRuntimeAttributeNone;
+    // required by the call watchdog, timeout can be set per call
+    auto res = JsRuntimeAttributeAllowScriptInterrupt;
     if (cfg.disable_background_work) {
         res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeDisableBackgroundWork);
     }
     if (cfg.disable_native_code_generation) {
         res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeDisableNativeCodeGeneration);
     }
+    if (cfg.enable_idle_processing) {
+        res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeEnableIdleProcessing);
+    }
+    if (cfg.disable_eval) {
+        res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeDisableEval);
+    }
+    if (cfg.enable_experimental_features) {
+        res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeEnableExperimentalFeatures);
+    }
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    if (cfg.disable_executable_page_allocation) {
+        res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeDisableExecutablePageAllocation);
+    }
+    if (cfg.disable_fatal_on_oom) {
+        res = static_cast<JsRuntimeAttributes> (res | JsRuntimeAttributeDisableFatalOnOOM);
+    }
+#endif // WILTON_CHAKRA_CHAKRACORE
     return res;
 }
 
-void register_c_func(const std::string& name, JsNativeFunction cb) {
-    JsValueRef global = JS_INVALID_REFERENCE;
-    auto err_global = JsGetGlobalObject(std::addressof(global));
+// watches the outermost call, execution is re-enabled after the
+// call returns, so the engine remains usable after timeout
+class watchdog_scope {
+    JsRuntimeHandle runtime;
+    chakra_watchdog* watchdog;
+    uint64_t token = 0;
+
+public:
+    // watchdog is owned by the engine, may be null if timeout is not set
+    watchdog_scope(JsRuntimeHandle runtime_handle, chakra_watchdog* engine_watchdog, uint32_t timeout_millis) :
+    runtime(runtime_handle),
+    watchdog(engine_watchdog) {
+        if (timeout_millis > 0) {
+            this->token = watchdog->arm(runtime, timeout_millis);
+        }
+    }
+
+    ~watchdog_scope() STATICLIB_NOEXCEPT {
+        disarm();
+    }
+
+    watchdog_scope(const watchdog_scope&) = delete;
+
+    watchdog_scope& operator=(const watchdog_scope&) = delete;
+
+    // returns true if execution was interrupted
+    bool disarm() STATICLIB_NOEXCEPT {
+        if (0 == token) {
+            return false;
+        }
+        auto fired = watchdog->disarm(token);
+        this->token = 0;
+        if (fired) {
+            JsEnableRuntimeExecution(runtime);
+        }
+        return fired;
+    }
+
+    // deadline stays armed, used between the items of a batch
+    bool fired() STATICLIB_NOEXCEPT {
+        return 0 != token && watchdog->fired(token);
+    }
+};
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+std::string property_string(JsValueRef obj, JsPropertyIdRef prop) STATICLIB_NOEXCEPT {
+    JsValueRef val = JS_INVALID_REFERENCE;
+    JsValueType vt = JsUndefined;
+    auto res = std::string();
+    if (JsNoError == JsGetProperty(obj, prop, std::addressof(val)) &&
+            JsNoError == JsGetValueType(val, std::addressof(vt)) && JsString == vt) {
+        copy_string(val, res);
+    }
+    return res;
+}
+
+int property_int(JsValueRef obj, JsPropertyIdRef prop) STATICLIB_NOEXCEPT {
+    JsValueRef val = JS_INVALID_REFERENCE;
+    int res = -1;
+    if (JsNoError == JsGetProperty(obj, prop, std::addressof(val))) {
+        JsNumberToInt(val, std::addressof(res));
+    }
+    return res;
+}
+
+// "name file" label of the function, separators used
+// by the collapsed-stack format are replaced
+std::string frame_label(engine_state& st, JsValueRef frame) {
+    auto handle = property_int(frame, st.function_handle_prop);
+    auto name = std::string();
+    auto file = std::string();
+    JsValueRef fun = JS_INVALID_REFERENCE;
+    if (handle >= 0 && JsNoError == JsDiagGetObjectFromHandle(static_cast<unsigned int>(handle), std::addressof(fun))) {
+        name = property_string(fun, st.name_prop);
+        file = property_string(fun, st.file_name_prop);
+    }
+    auto res = name.empty() ? std::string("(anonymous)") : name;
+    if (!file.empty()) {
+        res.push_back(' ');
+        res += support::script_engine_map_detail::shorten_script_path(file);
+    }
+    std::replace(res.begin(), res.end(), ';', ':');
+    std::replace(res.begin(), res.end(), '\n', ' ');
+    return res;
+}
+
+// outermost frame first, must be called from the debugger callback
+std::string collapsed_stack(engine_state& st) {
+    JsValueRef frames = JS_INVALID_REFERENCE;
+    auto err_trace = JsDiagGetStackTrace(std::addressof(frames));
+    if (JsNoError != err_trace) {
+        return std::string();
+    }
+    auto len = property_int(frames, st.length_prop);
+    auto res = std::string();
+    for (int i = len - 1; i >= 0; i--) {
+        JsValueRef idx = JS_INVALID_REFERENCE;
+        JsValueRef frame = JS_INVALID_REFERENCE;
+        if (JsNoError != JsIntToNumber(i, std::addressof(idx)) ||
+                JsNoError != JsGetIndexedProperty(frames, idx, std::addressof(frame))) {
+            continue;
+        }
+        if (!res.empty()) {
+            res.push_back(';');
+        }
+        res += frame_label(st, frame);
+    }
+    return res;
+}
+
+void CALLBACK profiler_debug_event(JsDiagDebugEvent event, JsValueRef /* event_data */,
+        void* callback_state) STATICLIB_NOEXCEPT {
+    // breakpoints are not set, other events are ignored
+    if (JsDiagDebugEventAsyncBreak != event) {
+        return;
+    }
+    auto st = static_cast<engine_state*>(callback_state);
+    try {
+        auto stack = collapsed_stack(*st);
+        if (!stack.empty()) {
+            st->profile->record(stack, st->profiler->max_stacks());
+        }
+    } catch (...) {
+        // sample is lost
+    }
+}
+
+// switches runtime in or out of the debug mode after profiler is started or stopped,
+// must be called with no JS code on the stack
+void sync_profiler(engine_state& st, JsRuntimeHandle runtime) STATICLIB_NOEXCEPT {
+    auto gen = st.profiler->generation();
+    if (gen == st.profiler_generation) {
+        return;
+    }
+    st.profiler_generation = gen;
+    auto enabled = st.profiler->enabled();
+    auto debugging = st.profile->debugging.load(std::memory_order_relaxed);
+    if (enabled && !debugging) {
+        auto err = JsDiagStartDebugging(runtime, profiler_debug_event, std::addressof(st));
+        if (JsNoError == err) {
+            st.profile->debugging.store(true, std::memory_order_release);
+        } else {
+            engine_log_warn(st, "wilton.engine.chakra.profiler", std::string() +
+                    "'JsDiagStartDebugging' error, code: [" + sl::support::to_string(err) + "]");
+        }
+    } else if (!enabled && debugging) {
+        st.profile->debugging.store(false, std::memory_order_release);
+        JsDiagStopDebugging(runtime, nullptr);
+    }
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+// marks engine as sampled for the duration of the top-level call
+class profiler_scope {
+    chakra_profile_shard* shard = nullptr;
+
+public:
+    profiler_scope(engine_state& st, JsRuntimeHandle runtime, bool top_level) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+        if (top_level) {
+            sync_profiler(st, runtime);
+            this->shard = st.profile.get();
+            shard->running.store(true, std::memory_order_release);
+        }
+#else // !WILTON_CHAKRA_CHAKRACORE
+        (void) st;
+        (void) runtime;
+        (void) top_level;
+#endif // WILTON_CHAKRA_CHAKRACORE
+    }
+
+    ~profiler_scope() STATICLIB_NOEXCEPT {
+        if (nullptr != shard) {
+            shard->running.store(false, std::memory_order_release);
+        }
+    }
+
+    profiler_scope(const profiler_scope&) = delete;
+
+    profiler_scope& operator=(const profiler_scope&) = delete;
+};
+
+// result of a single 'WILTON_run' invocation
+struct wilton_run_call {
+    JsErrorCode err = JsNoError;
+    JsValueRef value = JS_INVALID_REFERENCE;
+    chakra_call_stats* stats = nullptr;
+    uint64_t marshalling_micros = 0;
+};
+
+std::string timeout_message(uint32_t timeout_millis) {
+    return "Script execution timed out, timeout millis: [" + sl::support::to_string(timeout_millis) + "]";
+}
+
+// clock used by JsIdle for the next idle tick
+uint32_t platform_tick_millis() {
+#ifdef STATICLIB_WINDOWS
+    return static_cast<uint32_t>(::GetTickCount());
+#else // !STATICLIB_WINDOWS
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, std::addressof(ts));
+    return static_cast<uint32_t>(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif // STATICLIB_WINDOWS
+}
+
+uint64_t micros_since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+uint64_t micros_between(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+wiltoncall_site& find_wiltoncall_site(engine_state& st, const std::string& name) {
+    auto it = st.wiltoncall_sites.find(name);
+    if (st.wiltoncall_sites.end() != it) {
+        return *it->second;
+    }
+    auto site = sl::support::make_unique<wiltoncall_site>(name, st.callstats->wiltoncall(name));
+    auto& res = *site;
+    st.wiltoncall_sites.insert(std::make_pair(name, std::move(site)));
+    return res;
+}
+
+const std::string module_key = "\"module\"";
+
+// callback script is created by wilton as {"module": "...", "func": "...", "args": [...]},
+// module name is found without parsing the whole script
+void callback_module(sl::io::span<const char> json, std::string& out) {
+    out.clear();
+    auto end = json.data() + json.size();
+    auto pos = std::search(json.data(), end, module_key.begin(), module_key.end());
+    if (end != pos) {
+        pos += module_key.length();
+        while (end != pos && (' ' == *pos || ':' == *pos || '\t' == *pos || '\n' == *pos || '\r' == *pos)) {
+            pos += 1;
+        }
+        if (end != pos && '"' == *pos) {
+            auto start = pos + 1;
+            auto close = std::find(start, end, '"');
+            if (end != close) {
+                out.append(start, close);
+            }
+        }
+    }
+    if (out.empty()) {
+        out.append("<unknown>");
+    }
+}
+
+// engines are created concurrently, function-local
+// statics initialization is not thread-safe on msvc 2013
+std::mutex bytecode_cache_mutex;
+std::shared_ptr<chakra_bytecode_cache> bytecode_cache_instance;
+
+std::shared_ptr<chakra_bytecode_cache> shared_bytecode_cache(const std::string& dir) {
+    std::lock_guard<std::mutex> guard{bytecode_cache_mutex};
+    // cache dir is the same for all engines
+    if (nullptr == bytecode_cache_instance.get()) {
+        bytecode_cache_instance = std::make_shared<chakra_bytecode_cache>(dir);
+    }
+    return bytecode_cache_instance;
+}
+
+void add_ref(JsRef ref, const std::string& name) {
+    auto err = JsAddRef(ref, nullptr);
+    if (JsNoError != err) throw support::exception(TRACEMSG(
+            "'JsAddRef' error, name: [" + name + "]," +
+            " code: [" + sl::support::to_string(err) + "]"));
+}
+
+JsPropertyIdRef resolve_property_id(const std::string& name) {
+    JsPropertyIdRef prop = JS_INVALID_REFERENCE;
+    auto err_prop = create_property_id(name, std::addressof(prop));
+    if (JsNoError != err_prop) throw support::exception(TRACEMSG(
+            "'JsCreatePropertyId' error, name: [" + name + "]," +
+            " code: [" + sl::support::to_string(err_prop) + "]"));
+    add_ref(prop, name);
+    return prop;
+}
+
+void release_refs(JsRef** refs, size_t count) STATICLIB_NOEXCEPT {
+    for (size_t i = 0; i < count; i++) {
+        if (JS_INVALID_REFERENCE != *refs[i]) {
+            JsRelease(*refs[i], nullptr);
+            *refs[i] = JS_INVALID_REFERENCE;
+        }
+    }
+}
+
+// property ids are shared by all contexts of the runtime,
+// must be called with any context of the runtime set as current
+void init_engine_handles(engine_state& st) {
+    st.stack_prop = resolve_property_id("stack");
+    st.wilton_run_prop = resolve_property_id("WILTON_run");
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    st.length_prop = resolve_property_id("length");
+    st.function_handle_prop = resolve_property_id("functionHandle");
+    st.name_prop = resolve_property_id("name");
+    st.file_name_prop = resolve_property_id("fileName");
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+void release_engine_handles(engine_state& st) STATICLIB_NOEXCEPT {
+    auto refs = std::array<JsRef*, 6>();
+    refs[0] = std::addressof(st.wilton_run_prop);
+    refs[1] = std::addressof(st.stack_prop);
+    refs[2] = std::addressof(st.length_prop);
+    refs[3] = std::addressof(st.function_handle_prop);
+    refs[4] = std::addressof(st.name_prop);
+    refs[5] = std::addressof(st.file_name_prop);
+    release_refs(refs.data(), refs.size());
+    st.json.release();
+    for (auto& en : st.shared_buffers) {
+        JsRelease(en.second.buffer, nullptr);
+    }
+    st.shared_buffers.clear();
+}
+
+// must be called with this context set as current
+void init_context_handles(context_state& cs) {
+    auto err_global = JsGetGlobalObject(std::addressof(cs.global));
     if (JsNoError != err_global) throw support::exception(TRACEMSG(
-            "'JsGetGlobalObject' error, func name: [" + name + "]," +
-            " code: [" + sl::support::to_string(err_global) + "]"));
+            "'JsGetGlobalObject' error, code: [" + sl::support::to_string(err_global) + "]"));
+    add_ref(cs.global, "global");
+    auto err_null = JsGetNullValue(std::addressof(cs.null_value));
+    if (JsNoError != err_null) throw support::exception(TRACEMSG(
+            "'JsGetNullValue' error, code: [" + sl::support::to_string(err_null) + "]"));
+    add_ref(cs.null_value, "null");
+}
 
+void release_context_handles(context_state& cs) STATICLIB_NOEXCEPT {
+    auto refs = std::array<JsRef*, 3>();
+    refs[0] = std::addressof(cs.wilton_run_fun);
+    refs[1] = std::addressof(cs.null_value);
+    refs[2] = std::addressof(cs.global);
+    release_refs(refs.data(), refs.size());
+}
+
+void register_c_func(JsValueRef global, const std::string& name, JsNativeFunction cb, void* state) {
     JsPropertyIdRef prop = JS_INVALID_REFERENCE;
-    auto wname = sl::utils::widen(name);
-    auto err_prop = JsGetPropertyIdFromName(wname.c_str(), std::addressof(prop));
+    auto err_prop = create_property_id(name, std::addressof(prop));
     if (JsNoError != err_prop) throw support::exception(TRACEMSG(
             "'JsCreatePropertyId' error, func name: [" + name + "]," +
             " code: [" + sl::support::to_string(err_prop) + "]"));
 
     JsValueRef func = JS_INVALID_REFERENCE;
-    auto err_create = JsCreateFunction(cb, nullptr, std::addressof(func));
+    auto err_create = JsCreateFunction(cb, state, std::addressof(func));
     if (JsNoError != err_create) throw support::exception(TRACEMSG(
             "'JsCreateFunction' error, func name: [" + name + "]," +
             " code: [" + sl::support::to_string(err_create) + "]"));
@@ -105,32 +756,57 @@ std::string jsval_to_string(JsValueRef val) STATICLIB_NOEXCEPT {
     if (JsNoError != err_convert) return "";
 
     // extract string
-    int len = 0;
-    auto err_size = JsGetStringLength(val_str, std::addressof(len));
-    if (JsNoError != err_size) return "";
-    if (0 == len) return "";
+    auto res = std::string();
+    auto err_str = copy_string(val_str, res);
+    if (JsNoError != err_str) return "";
+    return res;
+}
+
+support::buffer string_to_buffer(JsValueRef str) {
+    // copied directly into wilton-allocated memory
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    size_t len = 0;
+    auto err_len = JsCopyString(str, nullptr, 0, std::addressof(len));
+    if (JsNoError != err_len) throw support::exception(TRACEMSG(
+            "'JsCopyString' error, code: [" + sl::support::to_string(err_len) + "]"));
+    auto buf = wilton_alloc(static_cast<int>(len) + 1);
+    if (nullptr == buf) throw support::exception(TRACEMSG(
+            "Error allocating result buffer, length: [" + sl::support::to_string(len) + "]"));
     size_t written = 0;
+    auto err_copy = JsCopyString(str, buf, len, std::addressof(written));
+    if (JsNoError != err_copy) {
+        wilton_free(buf);
+        throw support::exception(TRACEMSG(
+                "'JsCopyString' error, code: [" + sl::support::to_string(err_copy) + "]"));
+    }
+#else // !WILTON_CHAKRA_CHAKRACORE
+    size_t wlen = 0;
     const wchar_t* wptr = nullptr;
-    auto err_str = JsStringToPointer(val_str, std::addressof(wptr), std::addressof(written));
-    if (JsNoError != err_str) return "";
-    return sl::utils::narrow(wptr, written);
+    auto err_ptr = JsStringToPointer(str, std::addressof(wptr), std::addressof(wlen));
+    if (JsNoError != err_ptr) throw support::exception(TRACEMSG(
+            "'JsStringToPointer' error, code: [" + sl::support::to_string(err_ptr) + "]"));
+    auto len = 0 == wlen ? 0 : ::WideCharToMultiByte(CP_UTF8, 0, wptr, static_cast<int>(wlen),
+            nullptr, 0, nullptr, nullptr);
+    auto buf = wilton_alloc(len + 1);
+    if (nullptr == buf) throw support::exception(TRACEMSG(
+            "Error allocating result buffer, length: [" + sl::support::to_string(len) + "]"));
+    if (len > 0) {
+        ::WideCharToMultiByte(CP_UTF8, 0, wptr, static_cast<int>(wlen), buf, len, nullptr, nullptr);
+    }
+#endif // WILTON_CHAKRA_CHAKRACORE
+    buf[len] = '\0';
+    return support::wrap_wilton_buffer(buf, static_cast<int>(len));
 }
 
-std::string format_stack_trace(JsErrorCode err) STATICLIB_NOEXCEPT {
+std::string format_stack_trace(engine_state& st, JsErrorCode err) STATICLIB_NOEXCEPT {
     auto default_msg = std::string() + "Error code: [" + sl::support::to_string(err) + "]";
     JsValueRef exc = JS_INVALID_REFERENCE;
     auto err_get = JsGetAndClearException(std::addressof(exc));
     if (JsNoError != err_get) {
         return default_msg;
     }
-    JsPropertyIdRef prop = JS_INVALID_REFERENCE;
-    auto wname = sl::utils::widen("stack");
-    auto err_prop = JsGetPropertyIdFromName(wname.c_str(), std::addressof(prop));
-    if (JsNoError != err_prop) {
-        return default_msg;
-    }
     JsValueRef stack_ref = JS_INVALID_REFERENCE;
-    auto err_stack = JsGetProperty(exc, prop, std::addressof(stack_ref));
+    auto err_stack = JsGetProperty(exc, st.stack_prop, std::addressof(stack_ref));
     if (JsNoError != err_stack) {
         return default_msg;
     }
@@ -163,18 +839,13 @@ bool is_string_ref(JsValueRef val) {
     return JsString == vt;
 }
 
-std::string eval_js(const char* code, const std::string& path) {
-    auto wcode = sl::utils::widen(code);
-    auto wpath = sl::utils::widen(path);
-    auto hasher = std::hash<std::string>();
-    auto src_ctx = static_cast<JsSourceContext>(hasher(path));
-    JsValueRef res = JS_INVALID_REFERENCE;
-    auto err = JsRunScript(wcode.c_str(), src_ctx, wpath.c_str(), std::addressof(res));
+std::string eval_result(engine_state& st, JsErrorCode err, JsValueRef res,
+        const std::string& func, const std::string& path) {
     if (JsErrorInExceptionState == err) {
-        throw support::exception(TRACEMSG(format_stack_trace(err)));
+        throw support::exception(TRACEMSG(format_stack_trace(st, err)));
     }
     if (JsNoError != err) {
-        throw support::exception(TRACEMSG("'JsRunScript' error, path: [" + path + "]," +
+        throw support::exception(TRACEMSG("'" + func + "' error, path: [" + path + "]," +
                 " err: [" + sl::support::to_string(err) + "]"));
     }
     if (JS_INVALID_REFERENCE != res) {
@@ -190,61 +861,280 @@ std::string eval_js(const char* code, const std::string& path) {
     return "";
 }
 
-JsValueRef create_error(const std::string& msg) STATICLIB_NOEXCEPT {
-    JsValueRef str = JS_INVALID_REFERENCE;
-    auto wmsg = sl::utils::widen(msg);
-    auto err_str = JsPointerToString(wmsg.c_str(), wmsg.length(), std::addressof(str));
-    if (JsNoError != err_str) {
-        // fallback
-        auto wem = sl::utils::widen("ERROR");
-        JsPointerToString(wem.c_str(), wem.length(), std::addressof(str));
+JsSourceContext source_context(const std::string& path) {
+    auto hasher = std::hash<std::string>();
+    return static_cast<JsSourceContext>(hasher(path));
+}
+
+#ifndef WILTON_CHAKRA_CHAKRACORE
+JsErrorCode run_source(sl::io::span<const char> code, JsSourceContext src_ctx,
+        const std::string& path, JsValueRef* res) {
+    // nested loads may happen while script is running,
+    // so per-engine conversion buffer is not used here
+    auto wcode = std::wstring();
+    widen_into(code, wcode);
+    auto wpath = sl::utils::widen(path);
+    return JsRunScript(wcode.c_str(), src_ctx, wpath.c_str(), res);
+}
+#endif // !WILTON_CHAKRA_CHAKRACORE
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+void CALLBACK release_source(void* data) STATICLIB_NOEXCEPT {
+    delete static_cast<std::shared_ptr<chakra_script_source>*>(data);
+}
+
+// engine keeps the buffer (not a copy of the source) for deferred
+// parsing and stack traces, buffer keeps the shared source alive
+JsErrorCode create_source_buffer(const std::shared_ptr<chakra_script_source>& src, JsValueRef* res) {
+    auto holder = new std::shared_ptr<chakra_script_source>(src);
+    auto data = const_cast<char*>(src->data().data());
+    auto err = JsCreateExternalArrayBuffer(data, static_cast<unsigned int>(src->data().size()),
+            release_source, holder, res);
+    if (JsNoError != err) {
+        delete holder;
     }
+    return err;
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+std::string eval_source(engine_state& st, const std::shared_ptr<chakra_script_source>& src,
+        const std::string& path) {
     JsValueRef res = JS_INVALID_REFERENCE;
-    auto err_err = JsCreateError(str, std::addressof(res));
-    if (JsNoError != err_err) {
-        // fallback, todo: check me
-        JsCreateError(JS_INVALID_REFERENCE, std::addressof(res));
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    JsValueRef code_ref = JS_INVALID_REFERENCE;
+    auto err = create_source_buffer(src, std::addressof(code_ref));
+    JsValueRef path_ref = JS_INVALID_REFERENCE;
+    if (JsNoError == err) {
+        err = create_string({path.data(), path.length()}, std::addressof(path_ref));
     }
-    return res;
+    if (JsNoError == err) {
+        err = JsRun(code_ref, source_context(path), path_ref, JsParseScriptAttributeNone, std::addressof(res));
+    }
+#else // !WILTON_CHAKRA_CHAKRACORE
+    // jsrt takes UTF-16 sources only, so the source is widened per engine
+    auto err = run_source(src->data(), source_context(path), path, std::addressof(res));
+#endif // WILTON_CHAKRA_CHAKRACORE
+    return eval_result(st, err, res, "JsRun", path);
 }
 
-JsValueRef CALLBACK print_func(JsValueRef /* callee */, bool /* is_construct_call */,
-        JsValueRef* args, unsigned short args_count, void* /* callback_state */) STATICLIB_NOEXCEPT {
-    if (args_count > 1) {
-        auto val = jsval_to_string(args[1]);
-        puts(val.c_str());
-    } else {
-        puts("");
+bool serialize_script(engine_state& st, sl::io::span<const char> code, const std::string& path, std::vector<char>& out) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    JsValueRef code_ref = JS_INVALID_REFERENCE;
+    auto err_code = create_string(code, std::addressof(code_ref));
+    JsValueRef buf_ref = JS_INVALID_REFERENCE;
+    auto err_ser = JsNoError != err_code ? err_code :
+            JsSerialize(code_ref, std::addressof(buf_ref), JsParseScriptAttributeNone);
+    BYTE* ptr = nullptr;
+    unsigned int size = 0;
+    if (JsNoError == err_ser) {
+        err_ser = JsGetArrayBufferStorage(buf_ref, std::addressof(ptr), std::addressof(size));
     }
-    return JS_INVALID_REFERENCE;
+    if (JsNoError != err_ser) {
+        engine_log_warn(st, "wilton.engine.chakra.eval", std::string() + "Error serializing script," +
+                " path: [" + path + "], code: [" + sl::support::to_string(err_ser) + "]");
+        return false;
+    }
+#else // !WILTON_CHAKRA_CHAKRACORE
+    auto wcode = std::wstring();
+    widen_into(code, wcode);
+    unsigned long size = 0;
+    auto err_size = JsSerializeScript(wcode.c_str(), nullptr, std::addressof(size));
+    if (JsNoError != err_size) {
+        engine_log_warn(st, "wilton.engine.chakra.eval", std::string() + "Error serializing script," +
+                " path: [" + path + "], code: [" + sl::support::to_string(err_size) + "]");
+        return false;
+    }
+    auto buf = std::vector<BYTE>();
+    buf.resize(static_cast<size_t>(size));
+    auto err_ser = JsSerializeScript(wcode.c_str(), buf.data(), std::addressof(size));
+    if (JsNoError != err_ser) {
+        engine_log_warn(st, "wilton.engine.chakra.eval", std::string() + "Error serializing script," +
+                " path: [" + path + "], code: [" + sl::support::to_string(err_ser) + "]");
+        return false;
+    }
+    auto ptr = buf.data();
+#endif // WILTON_CHAKRA_CHAKRACORE
+    auto bytes = reinterpret_cast<const char*>(ptr);
+    out.assign(bytes, bytes + size);
+    return true;
 }
 
-JsValueRef CALLBACK load_func(JsValueRef /* callee */, bool /* is_construct_call */,
-        JsValueRef* args, unsigned short args_count, void* /* callback_state */) STATICLIB_NOEXCEPT {
-    auto path = std::string();
-    try {
-        // check args
-        if (args_count < 2 || !is_string_ref(args[1])) {
-            throw support::exception(TRACEMSG("Invalid arguments specified"));
+void store_bytecode(engine_state& st, chakra_bytecode_cache& cache, const chakra_script_source& src,
+        const std::string& path) {
+    if (!cache.should_store(path, src.hash())) {
+        return;
+    }
+    auto code = src.data();
+    auto bytecode = std::vector<char>();
+    if (serialize_script(st, code, path, bytecode)) {
+        cache.store(path, code.size(), src.hash(), {bytecode.data(), bytecode.size()});
+    }
+}
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+bool CALLBACK load_serialized_source(JsSourceContext src_ctx, JsValueRef* value,
+        JsParseScriptAttributes* parse_attrs) STATICLIB_NOEXCEPT {
+    auto ss = reinterpret_cast<serialized_script*>(src_ctx);
+    auto err = create_source_buffer(ss->source, value);
+    *parse_attrs = JsParseScriptAttributeNone;
+    return JsNoError == err;
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+JsErrorCode run_serialized(serialized_script& ss, const std::string& path, JsValueRef* res) {
+    auto bc_ptr = reinterpret_cast<BYTE*>(const_cast<char*>(ss.bytecode->data().data()));
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    // bytecode is only read by the engine
+    JsValueRef bc_ref = JS_INVALID_REFERENCE;
+    auto err_bc = JsCreateExternalArrayBuffer(bc_ptr, static_cast<unsigned int>(ss.bytecode->data().size()),
+            nullptr, nullptr, std::addressof(bc_ref));
+    if (JsNoError != err_bc) return err_bc;
+    JsValueRef path_ref = JS_INVALID_REFERENCE;
+    auto err_path = create_string({path.data(), path.length()}, std::addressof(path_ref));
+    if (JsNoError != err_path) return err_path;
+    auto src_ctx = reinterpret_cast<JsSourceContext>(std::addressof(ss));
+    return JsRunSerialized(bc_ref, load_serialized_source, src_ctx, path_ref, res);
+#else // !WILTON_CHAKRA_CHAKRACORE
+    auto wpath = sl::utils::widen(path);
+    return JsRunSerializedScript(ss.source.c_str(), bc_ptr, source_context(path), wpath.c_str(), res);
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+// entry is retained only if the engine accepts the bytecode
+JsErrorCode run_retained(engine_state& st, const std::shared_ptr<chakra_bytecode>& bc,
+        const std::shared_ptr<chakra_script_source>& src, const std::string& path, JsValueRef* res) {
+    auto it = st.serialized_scripts.find(bc.get());
+    if (st.serialized_scripts.end() != it) {
+        return run_serialized(*it->second, path, res);
+    }
+    auto ss = sl::support::make_unique<serialized_script>(bc, src);
+    auto err = run_serialized(*ss, path, res);
+    if (JsErrorBadSerializedScript != err) {
+        st.serialized_scripts.insert(std::make_pair(bc.get(), std::move(ss)));
+    }
+    return err;
+}
+
+std::string eval_source_cached(engine_state& st, const std::shared_ptr<chakra_script_source>& src,
+        const std::string& path) {
+    auto& cache = *st.bytecode_cache;
+    // source hash is computed once per process, not per load
+    auto bc = cache.load(path, src->data().size(), src->hash());
+    if (nullptr != bc.get()) {
+        JsValueRef res = JS_INVALID_REFERENCE;
+        auto err = run_retained(st, bc, src, path, std::addressof(res));
+        if (JsErrorBadSerializedScript != err) {
+            return eval_result(st, err, res, "JsRunSerialized", path);
         }
+        // created by other engine version
+        engine_log_debug(st, "wilton.engine.chakra.eval",
+                "Bytecode rejected by engine, path: [" + path + "]");
+        cache.invalidate(path);
+    }
+    auto str = eval_source(st, src, path);
+    store_bytecode(st, cache, *src, path);
+    return str;
+}
 
-        // load code
+// init code is the same for all engines, it is serialized once by the
+// first engine, other engines run the shared bytecode
+struct init_bundle {
+    uint64_t hash = 0;
+    std::shared_ptr<chakra_script_source> source;
+    std::shared_ptr<chakra_bytecode> bytecode;
+};
+
+const std::string init_code_path = std::string("wilton-require.js");
+
+std::mutex init_bundle_mutex;
+std::shared_ptr<init_bundle> init_bundle_instance;
+
+// must be called with a context set as current
+std::shared_ptr<init_bundle> shared_init_bundle(engine_state& st, sl::io::span<const char> code) {
+    auto hash = chakra_bytecode_cache::hash(code);
+    // engines created concurrently wait for the first one to serialize
+    std::lock_guard<std::mutex> guard{init_bundle_mutex};
+    auto cur = init_bundle_instance;
+    if (nullptr != cur.get() && hash == cur->hash && code.size() == cur->source->data().size()) {
+        return cur;
+    }
+    auto bundle = std::make_shared<init_bundle>();
+    bundle->hash = hash;
+    bundle->source = std::make_shared<chakra_script_source>(std::string(code.data(), code.size()));
+    auto bytecode = std::vector<char>();
+    if (serialize_script(st, bundle->source->data(), init_code_path, bytecode)) {
+        bundle->bytecode = std::make_shared<chakra_bytecode>(std::move(bytecode));
+    }
+    init_bundle_instance = bundle;
+    return bundle;
+}
+
+std::string eval_init_code(engine_state& st, sl::io::span<const char> code) {
+    auto bundle = shared_init_bundle(st, code);
+    if (nullptr != bundle->bytecode.get()) {
+        JsValueRef res = JS_INVALID_REFERENCE;
+        auto err = run_retained(st, bundle->bytecode, bundle->source, init_code_path, std::addressof(res));
+        if (JsErrorBadSerializedScript != err) {
+            return eval_result(st, err, res, "JsRunSerialized", init_code_path);
+        }
+        engine_log_warn(st, "wilton.engine.chakra.init", "Init bytecode rejected by engine");
+    }
+    return eval_source(st, bundle->source, init_code_path);
+}
+
+JsValueRef create_error(const std::string& msg) STATICLIB_NOEXCEPT {
+    JsValueRef str = JS_INVALID_REFERENCE;
+    auto err_str = create_string({msg.data(), msg.length()}, std::addressof(str));
+    if (JsNoError != err_str) {
+        // fallback
+        create_string({"ERROR", 5}, std::addressof(str));
+    }
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err_err = JsCreateError(str, std::addressof(res));
+    if (JsNoError != err_err) {
+        // fallback, todo: check me
+        JsCreateError(JS_INVALID_REFERENCE, std::addressof(res));
+    }
+    return res;
+}
+
+JsValueRef CALLBACK print_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto st = static_cast<engine_state*>(callback_state);
+    if (args_count > 1) {
+        engine_print(*st, jsval_to_string(args[1]));
+    } else {
+        engine_print(*st, std::string());
+    }
+    return JS_INVALID_REFERENCE;
+}
+
+JsValueRef CALLBACK load_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto path = std::string();
+    try {
+        // check args
+        if (args_count < 2 || !is_string_ref(args[1])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+
+        // load code, shared with other engines
         path = jsval_to_string(args[1]);
-        char* code = nullptr;
-        int code_len = 0;
-        auto err_load = wilton_load_resource(path.c_str(), static_cast<int>(path.length()),
-                std::addressof(code), std::addressof(code_len));
-        if (nullptr != err_load) {
-            support::throw_wilton_error(err_load, TRACEMSG(err_load));
-        }
-        auto deferred = sl::support::defer([code] () STATICLIB_NOEXCEPT {
-            wilton_free(code);
-        });
+        auto src = load_script_source(path);
         auto path_short = support::script_engine_map_detail::shorten_script_path(path);
-        wilton::support::log_debug("wilton.engine.chakra.eval",
-                "Evaluating source file, path: [" + path + "] ...");
-        eval_js(code, path_short);
-        wilton::support::log_debug("wilton.engine.chakra.eval", "Eval complete");
+        auto st = static_cast<engine_state*>(callback_state);
+        auto debug = st->eval_log.is_enabled();
+        if (debug) {
+            engine_log_debug(*st, st->eval_log.name(), "Evaluating source file, path: [" + path + "] ...");
+        }
+        if (nullptr != st->bytecode_cache.get()) {
+            eval_source_cached(*st, src, path_short);
+        } else {
+            eval_source(*st, src, path_short);
+        }
+        if (debug) {
+            engine_log_debug(*st, st->eval_log.name(), "Eval complete");
+        }
     } catch (const std::exception& e) {
         auto msg = TRACEMSG(e.what() + "\nError loading script, path: [" + path + "]");
         auto err = create_error(msg);
@@ -260,35 +1150,56 @@ JsValueRef CALLBACK load_func(JsValueRef /* callee */, bool /* is_construct_call
 }
 
 JsValueRef CALLBACK wiltoncall_func(JsValueRef /* callee */, bool /* is_construct_call */,
-        JsValueRef* args, unsigned short args_count, void* /* callback_state */) STATICLIB_NOEXCEPT {
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
     if (args_count < 3 || !is_string_ref(args[1]) || !is_string_ref(args[2])) {
         auto msg = TRACEMSG("Invalid arguments specified");
         auto err = create_error(msg);
         JsSetException(err);
         return JS_INVALID_REFERENCE;
     }
-    auto name = jsval_to_string(args[1]);
-    auto input = jsval_to_string(args[2]);
+    auto st = static_cast<engine_state*>(callback_state);
+    auto start = std::chrono::steady_clock::now();
+    pooled_string name_buf(st->buffers);
+    pooled_string input_buf(st->buffers);
+    auto& name = name_buf.value;
+    auto& input = input_buf.value;
+    auto err_name = copy_string(args[1], name);
+    auto err_input = JsNoError == err_name ? copy_string(args[2], input) : err_name;
+    if (JsNoError != err_input) {
+        auto msg = TRACEMSG("Error reading call arguments, code: [" + sl::support::to_string(err_input) + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    auto& site = find_wiltoncall_site(*st, name);
+    auto debug = site.log.is_enabled();
     char* out = nullptr;
     int out_len = 0;
-    wilton::support::log_debug("wilton.wiltoncall." + name,
-            "Performing a call,  input length: [" + sl::support::to_string(input.length()) + "] ...");
+    if (debug) {
+        engine_log_debug(*st, site.log.name(),
+                "Performing a call,  input length: [" + sl::support::to_string(input.length()) + "] ...");
+    }
+    auto call_start = std::chrono::steady_clock::now();
     auto err = wiltoncall(name.c_str(), static_cast<int> (name.length()),
             input.c_str(), static_cast<int> (input.length()),
             std::addressof(out), std::addressof(out_len));
-    wilton::support::log_debug("wilton.wiltoncall." + name,
-            "Call complete, result: [" + (nullptr != err ? std::string(err) : "") + "]");
+    auto call_end = std::chrono::steady_clock::now();
+    site.stats.native.record(micros_between(call_start, call_end));
+    if (debug) {
+        engine_log_debug(*st, site.log.name(),
+                "Call complete, result: [" + (nullptr != err ? std::string(err) : "") + "]");
+    }
     if (nullptr == err) {
         if (nullptr != out) {
             JsValueRef res = JS_INVALID_REFERENCE;
-            auto wout = sl::utils::widen(out, static_cast<size_t>(out_len));
-            auto err_str = JsPointerToString(wout.c_str(), wout.length(), std::addressof(res));
+            auto out_span = sl::io::span<const char>(const_cast<const char*>(out), out_len);
+            auto err_str = create_string(out_span, st->wbuf, std::addressof(res));
             if (JsNoError != err_str) {
                 // fallback
-                auto wem = sl::utils::widen("ERROR");
-                JsPointerToString(wem.c_str(), wem.length(), std::addressof(res));
+                create_string({"ERROR", 5}, std::addressof(res));
             }
             wilton_free(out);
+            site.stats.marshalling.record(micros_between(start, call_start) + micros_since(call_end));
             return res;
         } else {
             JsValueRef null_ref = JS_INVALID_REFERENCE;
@@ -304,106 +1215,2122 @@ JsValueRef CALLBACK wiltoncall_func(JsValueRef /* callee */, bool /* is_construc
     }
 }
 
-} // namespace
+void CALLBACK promise_continuation(JsValueRef task, void* callback_state) STATICLIB_NOEXCEPT {
+    auto st = static_cast<engine_state*>(callback_state);
+    JsContextRef ctx = JS_INVALID_REFERENCE;
+    auto err_ctx = JsGetCurrentContext(std::addressof(ctx));
+    auto err_ref = JsNoError == err_ctx ? JsAddRef(task, nullptr) : err_ctx;
+    if (JsNoError != err_ref) {
+        engine_log_warn(*st, "wilton.engine.chakra.async", std::string() + "Promise job dropped," +
+                " code: [" + sl::support::to_string(err_ref) + "]");
+        return;
+    }
+    auto job = promise_job();
+    job.ctx = ctx;
+    job.task = task;
+    st->promise_jobs.push_back(job);
+}
 
-class chakra_engine::impl : public sl::pimpl::object::impl {
-    JsRuntimeHandle runtime = JS_INVALID_RUNTIME_HANDLE;
+void run_promise_jobs(engine_state& st) {
+    while (!st.promise_jobs.empty()) {
+        auto job = st.promise_jobs.front();
+        st.promise_jobs.pop_front();
+        context_scope scope(job.ctx);
+        auto deferred = sl::support::defer([job] () STATICLIB_NOEXCEPT {
+            JsRelease(job.task, nullptr);
+        });
+        JsValueRef undefined = JS_INVALID_REFERENCE;
+        JsGetUndefinedValue(std::addressof(undefined));
+        JsValueRef res = JS_INVALID_REFERENCE;
+        auto err = JsCallFunction(job.task, std::addressof(undefined), 1, std::addressof(res));
+        if (JsNoError != err) {
+            engine_log_warn(st, "wilton.engine.chakra.async",
+                    "Promise job error: [" + format_stack_trace(st, err) + "]");
+        }
+    }
+}
 
-public:
-    ~impl() STATICLIB_NOEXCEPT {
-        JsSetCurrentContext(JS_INVALID_REFERENCE);
-        JsDisableRuntimeExecution(runtime);
-        JsDisposeRuntime(runtime);
+void settle_completion(engine_state& st, chakra_completion& co) {
+    auto out = co.out;
+    auto deferred_out = sl::support::defer([out] () STATICLIB_NOEXCEPT {
+        if (nullptr != out) {
+            wilton_free(out);
+        }
+    });
+    auto it = st.pending_calls.find(co.call_id);
+    if (st.pending_calls.end() == it) {
+        return;
     }
-    
-    impl(sl::io::span<const char> init_code) {
-        auto cfg = get_config();
-        wilton::support::log_info("wilton.engine.chakra.init", std::string() + "Initializing engine instance," +
-                " config: [" + cfg.to_json().dumps() + "]");
-        auto attrs = create_attributes(cfg);
-        wilton::support::log_info("wilton.engine.chakra.init", "Initializing engine instance ...");
-        auto err_runtime = JsCreateRuntime(attrs, JsRuntimeVersion11, nullptr, std::addressof(this->runtime));
-        if (JsNoError != err_runtime) throw support::exception(TRACEMSG(
-                "'JsCreateRuntime' error, code: [" + sl::support::to_string(err_runtime) + "]"));
-        if (cfg.runtime_memory_limit > 0) {
-            auto err_limit = JsSetRuntimeMemoryLimit(runtime, static_cast<size_t>(cfg.runtime_memory_limit));
-            if (JsNoError != err_limit) throw support::exception(TRACEMSG(
-                    "'JsSetRuntimeMemoryLimit' error, code: [" + sl::support::to_string(err_limit) + "]"));
+    auto pc = it->second;
+    st.pending_calls.erase(it);
+    context_scope scope(pc.ctx);
+    auto deferred_refs = sl::support::defer([pc] () STATICLIB_NOEXCEPT {
+        JsRelease(pc.resolve, nullptr);
+        JsRelease(pc.reject, nullptr);
+    });
+    JsValueRef fun = JS_INVALID_REFERENCE;
+    JsValueRef arg = JS_INVALID_REFERENCE;
+    if (co.error.empty()) {
+        fun = pc.resolve;
+        if (nullptr != out) {
+            auto out_span = sl::io::span<const char>(const_cast<const char*>(out), co.out_len);
+            auto err_str = create_string(out_span, st.wbuf, std::addressof(arg));
+            if (JsNoError != err_str) {
+                fun = pc.reject;
+                arg = create_error(TRACEMSG("'JsCreateString' error, code: [" + sl::support::to_string(err_str) + "]"));
+            }
+        } else {
+            JsGetNullValue(std::addressof(arg));
         }
-        JsContextRef ctx = JS_INVALID_REFERENCE;
-        auto err_ctx = JsCreateContext(runtime, nullptr, std::addressof(ctx));
-        if (JsNoError != err_runtime) throw support::exception(TRACEMSG(
-                "'JsCreateContext' error, code: [" + sl::support::to_string(err_ctx) + "]"));
-        auto err_set = JsSetCurrentContext(ctx);
+    } else {
+        fun = pc.reject;
+        arg = create_error(co.error);
+    }
+    auto args = std::array<JsValueRef, 2>();
+    JsGetUndefinedValue(std::addressof(args[0]));
+    args[1] = arg;
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err = JsCallFunction(fun, args.data(), static_cast<unsigned short>(args.size()), std::addressof(res));
+    if (JsNoError != err) {
+        engine_log_warn(st, "wilton.engine.chakra.async",
+                "Async call settle error: [" + format_stack_trace(st, err) + "]");
+    }
+}
+
+// resolves finished calls, continuations are queued as promise jobs
+void settle_completions(engine_state& st) {
+    st.completions->take_all(st.completions_buf);
+    for (auto& co : st.completions_buf) {
+        try {
+            settle_completion(st, co);
+        } catch (const std::exception& e) {
+            engine_log_warn(st, "wilton.engine.chakra.async", TRACEMSG(e.what() +
+                    "\nAsync call settle error, id: [" + sl::support::to_string(co.call_id) + "]"));
+        }
+    }
+    st.completions_buf.clear();
+}
+
+void release_timer(timer_task& task) STATICLIB_NOEXCEPT {
+    JsRelease(task.callback, nullptr);
+    for (auto arg : task.args) {
+        JsRelease(arg, nullptr);
+    }
+}
+
+void run_timer(engine_state& st, uint64_t id) {
+    auto it = st.timers.find(id);
+    if (st.timers.end() == it) {
+        // cancelled
+        return;
+    }
+    auto task = std::move(it->second);
+    st.timers.erase(it);
+    context_scope scope(task.ctx);
+    auto deferred = sl::support::defer([&task] () STATICLIB_NOEXCEPT {
+        release_timer(task);
+    });
+    auto args = std::vector<JsValueRef>();
+    args.reserve(task.args.size() + 1);
+    JsValueRef undefined = JS_INVALID_REFERENCE;
+    JsGetUndefinedValue(std::addressof(undefined));
+    args.push_back(undefined);
+    args.insert(args.end(), task.args.begin(), task.args.end());
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err = JsCallFunction(task.callback, args.data(), static_cast<unsigned short>(args.size()),
+            std::addressof(res));
+    if (JsNoError != err) {
+        engine_log_warn(st, "wilton.engine.chakra.async",
+                "Timer callback error: [" + format_stack_trace(st, err) + "]");
+    }
+}
+
+// immediates added while running are left for the next tick
+void run_immediates(engine_state& st) {
+    auto count = st.immediates.size();
+    for (size_t i = 0; i < count && !st.immediates.empty(); i++) {
+        auto id = st.immediates.front();
+        st.immediates.pop_front();
+        run_timer(st, id);
+        run_promise_jobs(st);
+    }
+}
+
+void run_due_timers(engine_state& st, std::chrono::steady_clock::time_point now) {
+    while (!st.timers_heap.empty() && st.timers_heap.front().deadline <= now) {
+        std::pop_heap(st.timers_heap.begin(), st.timers_heap.end());
+        auto id = st.timers_heap.back().id;
+        st.timers_heap.pop_back();
+        run_timer(st, id);
+        run_promise_jobs(st);
+    }
+}
+
+bool next_timer_deadline(engine_state& st, std::chrono::steady_clock::time_point& deadline) {
+    while (!st.timers_heap.empty() && st.timers.end() == st.timers.find(st.timers_heap.front().id)) {
+        std::pop_heap(st.timers_heap.begin(), st.timers_heap.end());
+        st.timers_heap.pop_back();
+    }
+    if (st.timers_heap.empty()) {
+        return false;
+    }
+    deadline = st.timers_heap.front().deadline;
+    return true;
+}
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+void CALLBACK release_transfer_holder(void* data) STATICLIB_NOEXCEPT {
+    auto holder = static_cast<transfer_holder*>(data);
+    // storage is empty if it was transferred
+    if (!holder->data.empty()) {
+        holder->state->transfer_buffers.erase(holder->data.data());
+    }
+    delete holder;
+}
+
+// buffer contents are not copied, buffer can be transferred again without copying
+JsValueRef create_transfer_buffer(engine_state& st, std::vector<char>&& data) {
+    JsValueRef res = JS_INVALID_REFERENCE;
+    if (data.empty()) {
+        auto err_empty = JsCreateArrayBuffer(0, std::addressof(res));
+        if (JsNoError != err_empty) throw support::exception(TRACEMSG(
+                "'JsCreateArrayBuffer' error, code: [" + sl::support::to_string(err_empty) + "]"));
+        return res;
+    }
+    auto holder = new transfer_holder(std::addressof(st), std::move(data));
+    auto ptr = holder->data.data();
+    auto err = JsCreateExternalArrayBuffer(ptr, static_cast<unsigned int>(holder->data.size()),
+            release_transfer_holder, holder, std::addressof(res));
+    if (JsNoError != err) {
+        delete holder;
+        throw support::exception(TRACEMSG(
+                "'JsCreateExternalArrayBuffer' error, code: [" + sl::support::to_string(err) + "]"));
+    }
+    st.transfer_buffers.insert(std::make_pair(const_cast<const char*>(ptr), holder));
+    return res;
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+void deliver_message(engine_state& st, chakra_message& msg) {
+    auto it = st.channel_listeners.find(msg.channel);
+    if (st.channel_listeners.end() == it) {
+        // channel was closed after the message was posted
+        return;
+    }
+    auto li = it->second;
+    context_scope scope(li.ctx);
+    auto args = std::array<JsValueRef, 4>();
+    JsGetUndefinedValue(std::addressof(args[0]));
+    args[1] = st.json.to_js(msg.data);
+    auto err_arr = JsCreateArray(static_cast<unsigned int>(msg.buffers.size()), std::addressof(args[2]));
+    if (JsNoError != err_arr) throw support::exception(TRACEMSG(
+            "'JsCreateArray' error, code: [" + sl::support::to_string(err_arr) + "]"));
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    for (size_t i = 0; i < msg.buffers.size(); i++) {
+        auto buf = create_transfer_buffer(st, std::move(msg.buffers[i]));
+        JsValueRef idx = JS_INVALID_REFERENCE;
+        JsIntToNumber(static_cast<int>(i), std::addressof(idx));
+        auto err_set = JsSetIndexedProperty(args[2], idx, buf);
         if (JsNoError != err_set) throw support::exception(TRACEMSG(
-                "'JsSetCurrentContext' error, code: [" + sl::support::to_string(err_set) + "]"));
-        register_c_func("print", print_func);
-        register_c_func("WILTON_load", load_func);
-        register_c_func("WILTON_wiltoncall", wiltoncall_func);
-        eval_js(init_code.data(), "wilton-require.js");
-        wilton::support::log_info("wilton.engine.chakra.init", "Engine initialization complete");
-    }
-
-    support::buffer run_callback_script(chakra_engine&, sl::io::span<const char> callback_script_json) {
-        wilton::support::log_debug("wilton.engine.chakra.run",
-                "Running callback script: [" + std::string(callback_script_json.data(), callback_script_json.size()) + "] ...");
-        // extract wilton_run
-        JsValueRef global = JS_INVALID_REFERENCE;
-        auto err_global = JsGetGlobalObject(&global);
-        if (JsNoError != err_global) throw support::exception(TRACEMSG(
-                "'JsGetGlobalObject' error, code: [" + sl::support::to_string(err_global) + "]"));
-        JsValueRef cb_arg_ref = JS_INVALID_REFERENCE;
-        auto wcb = sl::utils::widen(callback_script_json.data(), callback_script_json.size());
-        auto err_arg = JsPointerToString(wcb.c_str(), wcb.length(), std::addressof(cb_arg_ref));
-        if (JsNoError != err_arg) throw support::exception(TRACEMSG(
-                "'JsCreateString' error, code: [" + sl::support::to_string(err_arg) + "]"));
-        JsPropertyIdRef fun_prop = JS_INVALID_REFERENCE;
-        auto wname = sl::utils::widen("WILTON_run");
-        auto err_prop = JsGetPropertyIdFromName(wname.c_str(), std::addressof(fun_prop));
-        if (JsNoError != err_prop) throw support::exception(TRACEMSG(
-                "'JsCreatePropertyId' error, code: [" + sl::support::to_string(err_prop) + "]"));
-        JsValueRef fun = JS_INVALID_REFERENCE;
-        auto err_get = JsGetProperty(global, fun_prop, std::addressof(fun));
-        if (JsNoError != err_get) throw support::exception(TRACEMSG(
-                "'JsGetProperty' error, code: [" + sl::support::to_string(err_get) + "]"));
-        JsValueType fun_type = JsUndefined;
-        auto err_type = JsGetValueType(fun, std::addressof(fun_type));
-        if (JsNoError != err_type) throw support::exception(TRACEMSG(
-                "'JsGetValueType' error, code: [" + sl::support::to_string(err_type) + "]"));
-        if (JsFunction != fun_type) throw support::exception(TRACEMSG(
-                "Error accessing 'WILTON_run' function: not a function"));
-        JsValueRef null_ref = JS_INVALID_REFERENCE;
-        auto err_null = JsGetNullValue(std::addressof(null_ref));
-        if (JsNoError != err_null) throw support::exception(TRACEMSG(
-                "'JsGetNullValue' error, code: [" + sl::support::to_string(err_null) + "]"));
-        // call
-        auto args = std::array<JsValueRef, 2>();
-        args[0] = null_ref;
-        args[1] = cb_arg_ref;
-        JsValueRef res = JS_INVALID_REFERENCE;
-        auto err_call = JsCallFunction(fun, args.data(), static_cast<unsigned short>(args.size()), std::addressof(res));
-        wilton::support::log_debug("wilton.engine.jsc.run",
-                "Callback run complete, result: [" + sl::support::to_string_bool(JsNoError == err_call) + "]");
-        if (JsNoError != err_call) {
-            throw support::exception(TRACEMSG(format_stack_trace(err_call)));
+                "'JsSetIndexedProperty' error, code: [" + sl::support::to_string(err_set) + "]"));
+    }
+#endif // WILTON_CHAKRA_CHAKRACORE
+    auto err_name = create_string({msg.channel.data(), msg.channel.length()}, st.wbuf, std::addressof(args[3]));
+    if (JsNoError != err_name) throw support::exception(TRACEMSG(
+            "'JsCreateString' error, code: [" + sl::support::to_string(err_name) + "]"));
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err = JsCallFunction(li.callback, args.data(), static_cast<unsigned short>(args.size()), std::addressof(res));
+    if (JsNoError != err) {
+        engine_log_warn(st, "wilton.engine.chakra.channels",
+                "Channel listener error, channel: [" + msg.channel + "]," +
+                " error: [" + format_stack_trace(st, err) + "]");
+    }
+}
+
+// messages are taken in the order they were posted, promise jobs are drained after each listener
+void deliver_messages(engine_state& st) {
+    if (nullptr == st.mailbox.get()) {
+        return;
+    }
+    st.mailbox->take_all(st.messages_buf);
+    for (auto& msg : st.messages_buf) {
+        try {
+            deliver_message(st, msg);
+        } catch (const std::exception& e) {
+            engine_log_warn(st, "wilton.engine.chakra.channels", TRACEMSG(e.what() +
+                    "\nChannel message delivery error, channel: [" + msg.channel + "]"));
+        }
+        run_promise_jobs(st);
+    }
+    st.messages_buf.clear();
+}
+
+// promise jobs and async calls that already finished, does not wait
+void run_microtasks(engine_state& st) {
+    run_promise_jobs(st);
+    settle_completions(st);
+    run_promise_jobs(st);
+}
+
+bool has_pending_work(engine_state& st) {
+    return !st.promise_jobs.empty() || !st.pending_calls.empty() || !st.timers.empty();
+}
+
+/**
+ * Single iteration (tick) runs: promise jobs, finished async calls,
+ * channel messages, immediates and due timers, promise jobs are drained
+ * after each callback; between ticks the thread sleeps until the next timer,
+ * async completion or channel message
+ *
+ * @param listening channel listeners keep the loop running
+ * @return true if loop became idle, false if deadline was reached
+ */
+bool run_event_loop_until(engine_state& st, bool bounded, std::chrono::steady_clock::time_point deadline,
+        bool listening) {
+    for (;;) {
+        run_microtasks(st);
+        deliver_messages(st);
+        run_immediates(st);
+        run_due_timers(st, std::chrono::steady_clock::now());
+        if (!has_pending_work(st) && !(listening && !st.channel_listeners.empty())) {
+            return true;
+        }
+        if (bounded && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        if (!st.immediates.empty() || !st.promise_jobs.empty()) {
+            continue;
         }
-        if (is_string_ref(res)) {
-            auto str = jsval_to_string(res);
-            return support::make_string_buffer(str);
+        auto wake = std::chrono::steady_clock::time_point();
+        auto has_wake = next_timer_deadline(st, wake);
+        if (bounded && (!has_wake || deadline < wake)) {
+            wake = deadline;
+            has_wake = true;
+        }
+        if (has_wake) {
+            st.completions->wait_until(wake);
+        } else {
+            st.completions->wait();
         }
-        return support::make_null_buffer();
     }
+}
 
-    void run_garbage_collector(chakra_engine&) {
-        auto err = JsCollectGarbage(this->runtime);
-        if (JsNoError != err) throw support::exception(TRACEMSG(
-                "'JsCollectGarbage' error, code: [" + sl::support::to_string(err) + "]"));
+// jobs queued by a call interrupted by the watchdog are not run
+void drop_promise_jobs(engine_state& st) STATICLIB_NOEXCEPT {
+    for (auto& job : st.promise_jobs) {
+        JsRelease(job.task, nullptr);
+    }
+    st.promise_jobs.clear();
+}
+
+// must be called with any context of the runtime set as current
+void release_async_handles(engine_state& st) STATICLIB_NOEXCEPT {
+    drop_promise_jobs(st);
+    for (auto& en : st.pending_calls) {
+        JsRelease(en.second.resolve, nullptr);
+        JsRelease(en.second.reject, nullptr);
+    }
+    st.pending_calls.clear();
+    for (auto& en : st.timers) {
+        release_timer(en.second);
+    }
+    st.timers.clear();
+    st.timers_heap.clear();
+    st.immediates.clear();
+    for (auto& en : st.channel_listeners) {
+        JsRelease(en.second.callback, nullptr);
+    }
+    st.channel_listeners.clear();
+}
+
+// max delay accepted by browsers, larger values are clamped
+const double max_timer_delay_millis = 2147483647.0;
+
+uint64_t add_timer(engine_state& st, JsValueRef* args, unsigned short args_count,
+        unsigned short first_arg, double delay_millis, bool immediate) {
+    auto task = timer_task();
+    auto err_ctx = JsGetCurrentContext(std::addressof(task.ctx));
+    if (JsNoError != err_ctx) throw support::exception(TRACEMSG(
+            "'JsGetCurrentContext' error, code: [" + sl::support::to_string(err_ctx) + "]"));
+    add_ref(args[1], "timer callback");
+    task.callback = args[1];
+    for (unsigned short i = first_arg; i < args_count; i++) {
+        if (JsNoError == JsAddRef(args[i], nullptr)) {
+            task.args.push_back(args[i]);
+        }
+    }
+    auto id = st.next_timer_id;
+    st.next_timer_id += 1;
+    st.timers.insert(std::make_pair(id, std::move(task)));
+    if (immediate) {
+        st.immediates.push_back(id);
+    } else {
+        if (!(delay_millis > 0)) {
+            // NaN included
+            delay_millis = 0;
+        }
+        delay_millis = (std::min)(delay_millis, max_timer_delay_millis);
+        auto entry = timer_entry();
+        entry.deadline = std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(static_cast<int64_t>(delay_millis));
+        entry.id = id;
+        st.timers_heap.push_back(entry);
+        std::push_heap(st.timers_heap.begin(), st.timers_heap.end());
+        // cancelled timers are dropped lazily, heap is rebuilt if they pile up
+        if (st.timers_heap.size() > 64 && st.timers_heap.size() > st.timers.size() * 2) {
+            auto live = std::vector<timer_entry>();
+            for (auto& en : st.timers_heap) {
+                if (st.timers.end() != st.timers.find(en.id)) {
+                    live.push_back(en);
+                }
+            }
+            std::make_heap(live.begin(), live.end());
+            st.timers_heap.swap(live);
+        }
+    }
+    return id;
+}
+
+bool is_function_ref(JsValueRef val) {
+    JsValueType vt = JsUndefined;
+    auto err_type = JsGetValueType(val, std::addressof(vt));
+    if (JsNoError != err_type) throw support::exception(TRACEMSG(
+            "'JsGetValueType' error, code: [" + sl::support::to_string(err_type) + "]"));
+    return JsFunction == vt;
+}
+
+JsValueRef timer_id_to_js(uint64_t id) {
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err = JsDoubleToNumber(static_cast<double>(id), std::addressof(res));
+    if (JsNoError != err) throw support::exception(TRACEMSG(
+            "'JsDoubleToNumber' error, code: [" + sl::support::to_string(err) + "]"));
+    return res;
+}
+
+JsValueRef CALLBACK set_timeout_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    try {
+        if (args_count < 2 || !is_function_ref(args[1])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, callback function expected"));
+        }
+        double delay = 0;
+        if (args_count > 2) {
+            JsValueRef num = JS_INVALID_REFERENCE;
+            if (JsNoError == JsConvertValueToNumber(args[2], std::addressof(num))) {
+                JsNumberToDouble(num, std::addressof(delay));
+            }
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        auto id = add_timer(*st, args, args_count, 3, delay, false);
+        return timer_id_to_js(id);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\n'setTimeout' error");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+JsValueRef CALLBACK set_immediate_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    try {
+        if (args_count < 2 || !is_function_ref(args[1])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, callback function expected"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        auto id = add_timer(*st, args, args_count, 2, 0, true);
+        return timer_id_to_js(id);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\n'setImmediate' error");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+// used for both clearTimeout and clearImmediate, unknown ids are ignored
+JsValueRef CALLBACK clear_timer_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    if (args_count < 2) {
+        return JS_INVALID_REFERENCE;
+    }
+    double id = 0;
+    JsValueType vt = JsUndefined;
+    if (JsNoError != JsGetValueType(args[1], std::addressof(vt)) || JsNumber != vt ||
+            JsNoError != JsNumberToDouble(args[1], std::addressof(id)) || !(id > 0)) {
+        return JS_INVALID_REFERENCE;
+    }
+    auto st = static_cast<engine_state*>(callback_state);
+    auto it = st->timers.find(static_cast<uint64_t>(id));
+    if (st->timers.end() != it) {
+        release_timer(it->second);
+        st->timers.erase(it);
+    }
+    return JS_INVALID_REFERENCE;
+}
+
+JsValueRef CALLBACK channel_listen_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto name = std::string();
+    try {
+        if (args_count < 3 || !is_string_ref(args[1]) || !is_function_ref(args[2])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, expected: (string, function)"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        name = jsval_to_string(args[1]);
+        auto li = channel_listener();
+        auto err_ctx = JsGetCurrentContext(std::addressof(li.ctx));
+        if (JsNoError != err_ctx) throw support::exception(TRACEMSG(
+                "'JsGetCurrentContext' error, code: [" + sl::support::to_string(err_ctx) + "]"));
+        add_ref(args[2], "channel listener");
+        li.callback = args[2];
+        auto it = st->channel_listeners.find(name);
+        if (st->channel_listeners.end() != it) {
+            // callback is replaced, mailbox is already registered
+            JsRelease(it->second.callback, nullptr);
+            it->second = li;
+        } else {
+            st->channel_listeners.insert(std::make_pair(name, li));
+            channel_registry().listen(name, st->mailbox);
+        }
+        return JS_INVALID_REFERENCE;
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\n'WILTON_channel_listen' error, name: [" + name + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+// messages already in the mailbox are dropped on delivery
+JsValueRef CALLBACK channel_close_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto name = std::string();
+    try {
+        if (args_count < 2 || !is_string_ref(args[1])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, expected: (string)"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        name = jsval_to_string(args[1]);
+        auto it = st->channel_listeners.find(name);
+        auto found = st->channel_listeners.end() != it;
+        if (found) {
+            JsRelease(it->second.callback, nullptr);
+            st->channel_listeners.erase(it);
+            channel_registry().unlisten(name, st->mailbox.get());
+        }
+        JsValueRef res = JS_INVALID_REFERENCE;
+        JsBoolToBoolean(found, std::addressof(res));
+        return res;
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\n'WILTON_channel_close' error, name: [" + name + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+// buffer from the transfer list, holder is set if its storage was moved
+struct transfer_entry {
+    JsValueRef buffer = JS_INVALID_REFERENCE;
+    const char* key = nullptr;
+    size_t len = 0;
+    transfer_holder* holder = nullptr;
+};
+
+bool is_shared_store_buffer(engine_state& st, JsValueRef buf) {
+    for (auto& en : st.shared_buffers) {
+        auto same = false;
+        if (JsNoError == JsStrictEquals(buf, en.second.buffer, std::addressof(same)) && same) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// all buffers are checked before any of them is taken, empty (and already
+// detached) buffers are not detached, so every non-empty buffer is known
+// to be detachable before its storage is moved to the message
+std::vector<transfer_entry> read_transfer_list(engine_state& st, JsValueRef list) {
+    auto res = std::vector<transfer_entry>();
+    JsValueType vt = JsUndefined;
+    auto err_type = JsGetValueType(list, std::addressof(vt));
+    if (JsNoError != err_type) throw support::exception(TRACEMSG(
+            "'JsGetValueType' error, code: [" + sl::support::to_string(err_type) + "]"));
+    if (JsUndefined == vt || JsNull == vt) {
+        return res;
+    }
+    if (JsArray != vt) {
+        throw support::exception(TRACEMSG("Invalid transfer list, array of ArrayBuffers expected"));
+    }
+    auto len = property_int(list, st.length_prop);
+    for (int i = 0; i < len; i++) {
+        JsValueRef idx = JS_INVALID_REFERENCE;
+        JsValueRef buf = JS_INVALID_REFERENCE;
+        JsValueType bt = JsUndefined;
+        BYTE* ptr = nullptr;
+        unsigned int buf_len = 0;
+        if (JsNoError != JsIntToNumber(i, std::addressof(idx)) ||
+                JsNoError != JsGetIndexedProperty(list, idx, std::addressof(buf)) ||
+                JsNoError != JsGetValueType(buf, std::addressof(bt)) || JsArrayBuffer != bt ||
+                JsNoError != JsGetArrayBufferStorage(buf, std::addressof(ptr), std::addressof(buf_len))) {
+            throw support::exception(TRACEMSG("Invalid transfer list element, ArrayBuffer expected," +
+                    " index: [" + sl::support::to_string(i) + "]"));
+        }
+        // cached by the engine and returned again by 'WILTON_sharedStore_get'
+        if (is_shared_store_buffer(st, buf)) {
+            throw support::exception(TRACEMSG("Shared store buffers cannot be transferred," +
+                    " index: [" + sl::support::to_string(i) + "]"));
+        }
+        auto en = transfer_entry();
+        en.buffer = buf;
+        en.key = reinterpret_cast<const char*>(ptr);
+        en.len = static_cast<size_t>(buf_len);
+        for (auto& prev : res) {
+            if (en.len > 0 && en.key == prev.key) {
+                throw support::exception(TRACEMSG("Duplicate ArrayBuffer in transfer list," +
+                        " index: [" + sl::support::to_string(i) + "]"));
+            }
+        }
+        res.push_back(en);
+    }
+    return res;
+}
+
+// storage of channel buffers is moved, other buffers are copied
+void take_transfer_storage(engine_state& st, std::vector<transfer_entry>& list, chakra_message& msg) {
+    for (auto& en : list) {
+        auto it = en.len > 0 ? st.transfer_buffers.find(en.key) : st.transfer_buffers.end();
+        if (st.transfer_buffers.end() != it && en.len == it->second->data.size()) {
+            msg.buffers.emplace_back(std::move(it->second->data));
+            it->second->data.clear();
+            en.holder = it->second;
+        } else {
+            msg.buffers.emplace_back(en.key, en.key + en.len);
+        }
+    }
+}
+
+// moving a vector keeps its storage, so buffers still point to it
+void restore_transfer_storage(std::vector<transfer_entry>& list, chakra_message& msg) STATICLIB_NOEXCEPT {
+    for (size_t i = 0; i < list.size(); i++) {
+        if (nullptr != list[i].holder) {
+            list[i].holder->data = std::move(msg.buffers[i]);
+        }
+    }
+}
+
+// message is already accepted at this point
+void detach_transferred(engine_state& st, std::vector<transfer_entry>& list) {
+    auto copy_failed = false;
+    for (auto& en : list) {
+        if (0 == en.len) {
+            continue;
+        }
+        if (nullptr != en.holder) {
+            st.transfer_buffers.erase(en.key);
+        }
+        auto err = JsDetachArrayBuffer(en.buffer);
+        if (JsNoError == err) {
+            continue;
+        }
+        if (nullptr != en.holder) {
+            // storage now belongs to the receiving engine, script
+            // must not be able to access it from this thread, logged
+            // directly as the sink is not drained before abort
+            wilton::support::log_error("wilton.engine.chakra.channels", std::string() +
+                    "'JsDetachArrayBuffer' error on a moved buffer, aborting," +
+                    " code: [" + sl::support::to_string(err) + "]");
+            std::abort();
+        }
+        copy_failed = true;
+    }
+    if (copy_failed) {
+        throw support::exception(TRACEMSG("Message was posted, but transferred ArrayBuffer" +
+                " cannot be detached, it still holds the sent data"));
+    }
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+// returns false if all listener mailboxes are full, transferred
+// buffers are detached only when the message is accepted
+JsValueRef CALLBACK channel_post_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto name = std::string();
+    try {
+        if (args_count < 2 || !is_string_ref(args[1])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, expected: (string, any, [ArrayBuffer])"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        name = jsval_to_string(args[1]);
+        auto msg = chakra_message();
+        msg.channel = name;
+        if (args_count > 2) {
+            msg.data = st->json.from_js(args[2]);
+        }
+        auto accepted = false;
+#ifdef WILTON_CHAKRA_CHAKRACORE
+        auto list = args_count > 3 ? read_transfer_list(*st, args[3]) : std::vector<transfer_entry>();
+        take_transfer_storage(*st, list, msg);
+        try {
+            accepted = channel_registry().post(msg);
+        } catch (...) {
+            restore_transfer_storage(list, msg);
+            throw;
+        }
+        if (accepted) {
+            detach_transferred(*st, list);
+        } else {
+            restore_transfer_storage(list, msg);
+        }
+#else // !WILTON_CHAKRA_CHAKRACORE
+        JsValueType lt = JsUndefined;
+        if (args_count > 3 && (JsNoError != JsGetValueType(args[3], std::addressof(lt)) ||
+                (JsUndefined != lt && JsNull != lt))) {
+            throw support::exception(TRACEMSG("ArrayBuffer transfer is supported only with ChakraCore"));
+        }
+        accepted = channel_registry().post(msg);
+#endif // WILTON_CHAKRA_CHAKRACORE
+        JsValueRef res = JS_INVALID_REFERENCE;
+        JsBoolToBoolean(accepted, std::addressof(res));
+        return res;
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\n'WILTON_channel_post' error, name: [" + name + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+// zero-filled buffer that is transferred without copying
+JsValueRef CALLBACK channel_allocate_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    try {
+        double size = -1;
+        JsValueType vt = JsUndefined;
+        if (args_count < 2 || JsNoError != JsGetValueType(args[1], std::addressof(vt)) || JsNumber != vt ||
+                JsNoError != JsNumberToDouble(args[1], std::addressof(size)) ||
+                !(size >= 0) || size > static_cast<double>((std::numeric_limits<unsigned int>::max)())) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, buffer size expected"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        return create_transfer_buffer(*st, std::vector<char>(static_cast<size_t>(size)));
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\n'WILTON_channel_allocate' error");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+// only objects and arrays are returned as structured values,
+// other results are returned as strings
+bool is_structured(const char* out, int out_len) {
+    for (int i = 0; i < out_len; i++) {
+        switch (out[i]) {
+        case ' ': case '\t': case '\r': case '\n':
+            continue;
+        case '{': case '[':
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+// native output of a call made with 'WILTON_wiltoncall_lazy', parsed on
+// first access, only the requested parts are converted to JS values
+struct lazy_result {
+    engine_state* state;
+    char* out;
+    int out_len;
+    sl::json::value json;
+    bool released = false;
+
+    lazy_result(engine_state* engine_st, char* out_data, int out_data_len) :
+    state(engine_st),
+    out(out_data),
+    out_len(out_data_len) { }
+
+    ~lazy_result() STATICLIB_NOEXCEPT {
+        release_output();
+    }
+
+    lazy_result(const lazy_result&) = delete;
+
+    lazy_result& operator=(const lazy_result&) = delete;
+
+    const sl::json::value& root() {
+        if (nullptr != out) {
+            this->json = sl::json::load({const_cast<const char*>(out), out_len});
+            // output is not needed after parsing
+            release_output();
+        }
+        return json;
+    }
+
+    void release_output() STATICLIB_NOEXCEPT {
+        if (nullptr != out) {
+            wilton_free(out);
+            this->out = nullptr;
+        }
+    }
+};
+
+void CALLBACK release_lazy_result(void* data) STATICLIB_NOEXCEPT {
+    auto lr = static_cast<lazy_result*>(data);
+    lr->state->lazy_results.erase(lr);
+    delete lr;
+}
+
+JsValueRef create_lazy_result(engine_state& st, char* out, int out_len) {
+    auto lr = new lazy_result(std::addressof(st), out, out_len);
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err = JsCreateExternalObject(lr, release_lazy_result, std::addressof(res));
+    if (JsNoError != err) {
+        delete lr;
+        throw support::exception(TRACEMSG(
+                "'JsCreateExternalObject' error, code: [" + sl::support::to_string(err) + "]"));
+    }
+    st.lazy_results.insert(lr);
+    return res;
+}
+
+// external data of other objects is only compared, never dereferenced
+lazy_result& find_lazy_result(engine_state& st, JsValueRef handle) {
+    void* data = nullptr;
+    auto err = JsGetExternalData(handle, std::addressof(data));
+    auto lr = static_cast<lazy_result*>(data);
+    if (JsNoError != err || st.lazy_results.end() == st.lazy_results.find(lr)) {
+        throw support::exception(TRACEMSG("Invalid lazy result handle specified"));
+    }
+    if (lr->released) {
+        throw support::exception(TRACEMSG("Lazy result handle is released"));
+    }
+    return *lr;
+}
+
+// path is either an array of keys and indices, or a string with
+// dot-separated segments, undefined or empty string points to the root
+std::vector<std::string> lazy_path_segments(engine_state& st, JsValueRef* args, unsigned short args_count) {
+    auto res = std::vector<std::string>();
+    if (args_count < 3) {
+        return res;
+    }
+    if (is_string_ref(args[2])) {
+        auto path = jsval_to_string(args[2]);
+        if (!path.empty()) {
+            res = sl::utils::split(path, '.');
+        }
+        return res;
+    }
+    auto json = st.json.from_js(args[2]);
+    if (sl::json::type::nullt == json.json_type()) {
+        return res;
+    }
+    for (auto& el : json.as_array_or_throw("path")) {
+        if (sl::json::type::string == el.json_type()) {
+            res.push_back(el.as_string());
+        } else {
+            res.push_back(sl::support::to_string(el.as_uint32_or_throw("path")));
+        }
+    }
+    return res;
+}
+
+const sl::json::value& lazy_lookup(lazy_result& lr, const std::vector<std::string>& path) {
+    const sl::json::value* cur = std::addressof(lr.root());
+    for (auto& seg : path) {
+        const sl::json::value* next = nullptr;
+        if (sl::json::type::object == cur->json_type()) {
+            for (auto& fi : cur->as_object()) {
+                if (seg == fi.name()) {
+                    next = std::addressof(fi.val());
+                    break;
+                }
+            }
+        } else if (sl::json::type::array == cur->json_type()) {
+            auto& arr = cur->as_array();
+            auto idx = sl::utils::parse_uint32(seg);
+            if (idx < arr.size()) {
+                next = std::addressof(arr[idx]);
+            }
+        }
+        if (nullptr == next) throw support::exception(TRACEMSG(
+                "Invalid lazy result path, segment not found: [" + seg + "]"));
+        cur = next;
+    }
+    return *cur;
+}
+
+// common part of the lazy result accessors
+JsValueRef lazy_access(JsValueRef* args, unsigned short args_count, void* callback_state,
+        std::function<JsValueRef(engine_state&, lazy_result&, const std::vector<std::string>&)> fun) {
+    try {
+        if (args_count < 2) {
+            throw support::exception(TRACEMSG("Invalid arguments specified, expected: (handle, path)"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        auto& lr = find_lazy_result(*st, args[1]);
+        auto path = lazy_path_segments(*st, args, args_count);
+        return fun(*st, lr, path);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nLazy result access error");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+JsValueRef CALLBACK lazy_get_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    return lazy_access(args, args_count, callback_state,
+            [](engine_state& st, lazy_result& lr, const std::vector<std::string>& path) {
+        return st.json.to_js(lazy_lookup(lr, path));
+    });
+}
+
+JsValueRef CALLBACK lazy_length_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    return lazy_access(args, args_count, callback_state,
+            [](engine_state&, lazy_result& lr, const std::vector<std::string>& path) {
+        auto& val = lazy_lookup(lr, path);
+        // number of elements or fields, zero for primitives
+        size_t len = 0;
+        if (sl::json::type::array == val.json_type()) {
+            len = val.as_array().size();
+        } else if (sl::json::type::object == val.json_type()) {
+            len = val.as_object().size();
+        }
+        JsValueRef res = JS_INVALID_REFERENCE;
+        JsDoubleToNumber(static_cast<double>(len), std::addressof(res));
+        return res;
+    });
+}
+
+JsValueRef CALLBACK lazy_keys_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    return lazy_access(args, args_count, callback_state,
+            [](engine_state& st, lazy_result& lr, const std::vector<std::string>& path) {
+        auto& val = lazy_lookup(lr, path);
+        auto keys = std::vector<sl::json::value>();
+        if (sl::json::type::object == val.json_type()) {
+            for (auto& fi : val.as_object()) {
+                keys.emplace_back(fi.name());
+            }
+        }
+        return st.json.to_js(sl::json::value(std::move(keys)));
+    });
+}
+
+JsValueRef CALLBACK lazy_release_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    // frees native memory before the handle is collected,
+    // handle cannot be accessed after that
+    return lazy_access(args, args_count, callback_state,
+            [](engine_state&, lazy_result& lr, const std::vector<std::string>&) -> JsValueRef {
+        lr.release_output();
+        lr.json = sl::json::value();
+        lr.released = true;
+        return JS_INVALID_REFERENCE;
+    });
+}
+
+JsValueRef wiltoncall_json_impl(JsValueRef* args, unsigned short args_count, void* callback_state,
+        bool lazy) STATICLIB_NOEXCEPT {
+    auto name = std::string();
+    try {
+        if (args_count < 2 || !is_string_ref(args[1])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        auto start = std::chrono::steady_clock::now();
+        auto err_name = copy_string(args[1], name);
+        if (JsNoError != err_name) throw support::exception(TRACEMSG(
+                "Error reading call name, code: [" + sl::support::to_string(err_name) + "]"));
+        auto& site = find_wiltoncall_site(*st, name);
+        auto debug = site.log.is_enabled();
+        // strings are passed as is, null and undefined as empty input
+        pooled_string input_buf(st->buffers);
+        auto& input = input_buf.value;
+        if (args_count > 2) {
+            if (is_string_ref(args[2])) {
+                auto err_input = copy_string(args[2], input);
+                if (JsNoError != err_input) throw support::exception(TRACEMSG(
+                        "Error reading call input, code: [" + sl::support::to_string(err_input) + "]"));
+            } else {
+                auto json = st->json.from_js(args[2]);
+                if (sl::json::type::nullt != json.json_type()) {
+                    input = json.dumps();
+                }
+            }
+        }
+        char* out = nullptr;
+        int out_len = 0;
+        if (debug) {
+            engine_log_debug(*st, site.log.name(),
+                    "Performing a call,  input length: [" + sl::support::to_string(input.length()) + "] ...");
+        }
+        auto call_start = std::chrono::steady_clock::now();
+        auto err = wiltoncall(name.c_str(), static_cast<int> (name.length()),
+                input.c_str(), static_cast<int> (input.length()),
+                std::addressof(out), std::addressof(out_len));
+        auto call_end = std::chrono::steady_clock::now();
+        site.stats.native.record(micros_between(call_start, call_end));
+        if (debug) {
+            engine_log_debug(*st, site.log.name(),
+                    "Call complete, result: [" + (nullptr != err ? std::string(err) : "") + "]");
+        }
+        // output conversion time is recorded on return
+        auto marshalled = sl::support::defer([&site, start, call_start, call_end] () STATICLIB_NOEXCEPT {
+            site.stats.marshalling.record(micros_between(start, call_start) + micros_since(call_end));
+        });
+        if (nullptr != err) {
+            auto msg = TRACEMSG(err + "\n'wiltoncall_json' error for name: [" + name + "]");
+            wilton_free(err);
+            throw support::exception(msg);
+        }
+        if (nullptr == out) {
+            JsValueRef null_ref = JS_INVALID_REFERENCE;
+            JsGetNullValue(std::addressof(null_ref));
+            return null_ref;
+        }
+        if (lazy && is_structured(out, out_len)) {
+            // ownership of the output is passed to the handle
+            try {
+                return create_lazy_result(*st, out, out_len);
+            } catch (...) {
+                wilton_free(out);
+                throw;
+            }
+        }
+        auto deferred = sl::support::defer([out] () STATICLIB_NOEXCEPT {
+            wilton_free(out);
+        });
+        auto out_span = sl::io::span<const char>(const_cast<const char*>(out), out_len);
+        if (is_structured(out, out_len)) {
+            auto json = sl::json::load(out_span);
+            return st->json.to_js(json);
+        }
+        JsValueRef res = JS_INVALID_REFERENCE;
+        auto err_str = create_string(out_span, st->wbuf, std::addressof(res));
+        if (JsNoError != err_str) throw support::exception(TRACEMSG(
+                "'JsCreateString' error, code: [" + sl::support::to_string(err_str) + "]"));
+        return res;
+    } catch (const std::exception& e) {
+        // exception from toJSON may be already set
+        auto has_exception = false;
+        JsHasException(std::addressof(has_exception));
+        if (!has_exception) {
+            auto msg = TRACEMSG(e.what() + "\nError performing call, name: [" + name + "]");
+            auto err = create_error(msg);
+            JsSetException(err);
+        }
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+JsValueRef CALLBACK wiltoncall_json_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    return wiltoncall_json_impl(args, args_count, callback_state, false);
+}
+
+JsValueRef CALLBACK wiltoncall_lazy_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    return wiltoncall_json_impl(args, args_count, callback_state, true);
+}
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+void CALLBACK release_wilton_buffer(void* data) STATICLIB_NOEXCEPT {
+    wilton_free(static_cast<char*>(data));
+}
+
+// points directly into the engine-owned storage, valid while the value is alive
+JsErrorCode binary_storage(JsValueRef val, sl::io::span<const char>& out) STATICLIB_NOEXCEPT {
+    JsValueType vt = JsUndefined;
+    auto err_type = JsGetValueType(val, std::addressof(vt));
+    if (JsNoError != err_type) return err_type;
+    BYTE* ptr = nullptr;
+    unsigned int len = 0;
+    auto err = JsErrorInvalidArgument;
+    switch (vt) {
+    case JsArrayBuffer:
+        err = JsGetArrayBufferStorage(val, std::addressof(ptr), std::addressof(len));
+        break;
+    case JsTypedArray:
+        err = JsGetTypedArrayStorage(val, std::addressof(ptr), std::addressof(len), nullptr, nullptr);
+        break;
+    case JsDataView:
+        err = JsGetDataViewStorage(val, std::addressof(ptr), std::addressof(len));
+        break;
+    default:
+        break;
+    }
+    if (JsNoError == err) {
+        out = sl::io::span<const char>(reinterpret_cast<const char*>(ptr), static_cast<size_t>(len));
+    }
+    return err;
+}
+
+JsValueRef CALLBACK wiltoncall_async_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto name = std::string();
+    try {
+        if (args_count < 3 || !is_string_ref(args[1]) || !is_string_ref(args[2])) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+        auto st = static_cast<engine_state*>(callback_state);
+        // copied, call is performed on other thread
+        auto input = std::string();
+        auto err_name = copy_string(args[1], name);
+        auto err_input = JsNoError == err_name ? copy_string(args[2], input) : err_name;
+        if (JsNoError != err_input) throw support::exception(TRACEMSG(
+                "Error reading call arguments, code: [" + sl::support::to_string(err_input) + "]"));
+        JsValueRef promise = JS_INVALID_REFERENCE;
+        auto pc = pending_call();
+        auto err_promise = JsCreatePromise(std::addressof(promise), std::addressof(pc.resolve),
+                std::addressof(pc.reject));
+        if (JsNoError != err_promise) throw support::exception(TRACEMSG(
+                "'JsCreatePromise' error, code: [" + sl::support::to_string(err_promise) + "]"));
+        auto err_ctx = JsGetCurrentContext(std::addressof(pc.ctx));
+        if (JsNoError != err_ctx) throw support::exception(TRACEMSG(
+                "'JsGetCurrentContext' error, code: [" + sl::support::to_string(err_ctx) + "]"));
+        auto pool = shared_worker_pool(st->async_worker_threads);
+        auto id = st->next_call_id;
+        st->next_call_id += 1;
+        add_ref(pc.resolve, "resolve");
+        add_ref(pc.reject, "reject");
+        st->pending_calls.insert(std::make_pair(id, pc));
+        auto queue = st->completions;
+        auto& site = find_wiltoncall_site(*st, name);
+        if (site.log.is_enabled()) {
+            engine_log_debug(*st, site.log.name(),
+                    "Submitting async call,  input length: [" + sl::support::to_string(input.length()) + "] ...");
+        }
+        pool->submit([queue, id, name, input] {
+            auto co = chakra_completion();
+            co.call_id = id;
+            auto err = wiltoncall(name.c_str(), static_cast<int> (name.length()),
+                    input.c_str(), static_cast<int> (input.length()),
+                    std::addressof(co.out), std::addressof(co.out_len));
+            if (nullptr != err) {
+                co.error = TRACEMSG(err + "\n'wiltoncall_async' error for name: [" + name + "]");
+                wilton_free(err);
+            }
+            queue->push(std::move(co));
+        });
+        return promise;
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError performing async call, name: [" + name + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+JsValueRef CALLBACK wiltoncall_bin_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto input = sl::io::span<const char>(nullptr, 0);
+    if (args_count < 3 || !is_string_ref(args[1]) || JsNoError != binary_storage(args[2], input)) {
+        auto msg = TRACEMSG("Invalid arguments specified, expected: (string, ArrayBuffer|TypedArray|DataView)");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    auto st = static_cast<engine_state*>(callback_state);
+    pooled_string name_buf(st->buffers);
+    auto& name = name_buf.value;
+    auto err_name = copy_string(args[1], name);
+    if (JsNoError != err_name) {
+        auto msg = TRACEMSG("Error reading call name, code: [" + sl::support::to_string(err_name) + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    auto& site = find_wiltoncall_site(*st, name);
+    auto debug = site.log.is_enabled();
+    char* out = nullptr;
+    int out_len = 0;
+    if (debug) {
+        engine_log_debug(*st, site.log.name(),
+                "Performing a binary call,  input length: [" + sl::support::to_string(input.size()) + "] ...");
+    }
+    // empty buffers may have no storage, binary input and output are not copied
+    auto input_ptr = nullptr != input.data() ? input.data() : "";
+    auto call_start = std::chrono::steady_clock::now();
+    auto err = wiltoncall(name.c_str(), static_cast<int> (name.length()),
+            input_ptr, static_cast<int> (input.size()),
+            std::addressof(out), std::addressof(out_len));
+    site.stats.native.record(micros_since(call_start));
+    if (debug) {
+        engine_log_debug(*st, site.log.name(),
+                "Call complete, result: [" + (nullptr != err ? std::string(err) : "") + "]");
+    }
+    if (nullptr != err) {
+        auto msg = TRACEMSG(err + "\n'wiltoncall_bin' error for name: [" + name + "]");
+        wilton_free(err);
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    if (nullptr == out) {
+        JsValueRef null_ref = JS_INVALID_REFERENCE;
+        JsGetNullValue(std::addressof(null_ref));
+        return null_ref;
+    }
+    // ownership of the output is passed to the engine
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err_buf = JsCreateExternalArrayBuffer(out, static_cast<unsigned int>(out_len),
+            release_wilton_buffer, out, std::addressof(res));
+    if (JsNoError != err_buf) {
+        wilton_free(out);
+        auto msg = TRACEMSG("'JsCreateExternalArrayBuffer' error, code: [" + sl::support::to_string(err_buf) + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    return res;
+}
+
+void CALLBACK release_shared_blob(void* data) STATICLIB_NOEXCEPT {
+    delete static_cast<std::shared_ptr<const chakra_shared_blob>*>(data);
+}
+
+JsValueRef create_shared_buffer(std::shared_ptr<const chakra_shared_blob> blob) {
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto data = blob->data();
+    if (0 == data.size()) {
+        auto err_empty = JsCreateArrayBuffer(0, std::addressof(res));
+        if (JsNoError != err_empty) throw support::exception(TRACEMSG(
+                "'JsCreateArrayBuffer' error, code: [" + sl::support::to_string(err_empty) + "]"));
+        return res;
+    }
+    // blob reference is owned by the buffer and released by GC,
+    // contents are not copied
+    auto holder = new std::shared_ptr<const chakra_shared_blob>(std::move(blob));
+    auto err = JsCreateExternalArrayBuffer(const_cast<char*>(data.data()), static_cast<unsigned int>(data.size()),
+            release_shared_blob, holder, std::addressof(res));
+    if (JsNoError != err) {
+        delete holder;
+        throw support::exception(TRACEMSG(
+                "'JsCreateExternalArrayBuffer' error, code: [" + sl::support::to_string(err) + "]"));
+    }
+    return res;
+}
+
+// the same buffer is returned while blob version stays the same,
+// store mutex is not taken if nothing was published since the last check
+JsValueRef find_shared_buffer(engine_state& st, const std::string& name) {
+    auto& store = shared_store();
+    auto gen = store.generation();
+    auto it = st.shared_buffers.find(name);
+    if (st.shared_buffers.end() != it && gen == it->second.checked_generation) {
+        return it->second.buffer;
+    }
+    auto blob = store.get(name);
+    if (nullptr == blob.get()) {
+        if (st.shared_buffers.end() != it) {
+            JsRelease(it->second.buffer, nullptr);
+            st.shared_buffers.erase(it);
+        }
+        return JS_INVALID_REFERENCE;
+    }
+    if (st.shared_buffers.end() != it && blob->version() == it->second.version) {
+        it->second.checked_generation = gen;
+        return it->second.buffer;
+    }
+    auto version = blob->version();
+    auto buf = create_shared_buffer(std::move(blob));
+    add_ref(buf, "shared buffer");
+    auto& en = st.shared_buffers[name];
+    if (JS_INVALID_REFERENCE != en.buffer) {
+        JsRelease(en.buffer, nullptr);
+    }
+    en.version = version;
+    en.checked_generation = gen;
+    en.buffer = buf;
+    return buf;
+}
+
+JsValueRef CALLBACK shared_store_get_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    if (args_count < 2 || !is_string_ref(args[1])) {
+        auto msg = TRACEMSG("Invalid arguments specified, expected: (string)");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    auto st = static_cast<engine_state*>(callback_state);
+    try {
+        auto name = jsval_to_string(args[1]);
+        auto res = find_shared_buffer(*st, name);
+        if (JS_INVALID_REFERENCE == res) {
+            JsGetNullValue(std::addressof(res));
+        }
+        return res;
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nShared store access error");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+JsValueRef CALLBACK shared_store_version_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* /* callback_state */) STATICLIB_NOEXCEPT {
+    if (args_count < 2 || !is_string_ref(args[1])) {
+        auto msg = TRACEMSG("Invalid arguments specified, expected: (string)");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    auto name = jsval_to_string(args[1]);
+    auto blob = shared_store().get(name);
+    // zero if not published
+    auto version = nullptr != blob.get() ? blob->version() : 0;
+    JsValueRef res = JS_INVALID_REFERENCE;
+    JsDoubleToNumber(static_cast<double>(version), std::addressof(res));
+    return res;
+}
+
+JsValueRef CALLBACK shared_store_publish_func(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* /* callback_state */) STATICLIB_NOEXCEPT {
+    auto input = sl::io::span<const char>(nullptr, 0);
+    auto str = std::string();
+    auto valid = args_count >= 3 && is_string_ref(args[1]);
+    if (valid) {
+        valid = is_string_ref(args[2]) ? JsNoError == copy_string(args[2], str) :
+                JsNoError == binary_storage(args[2], input);
+    }
+    if (!valid) {
+        auto msg = TRACEMSG("Invalid arguments specified, expected: (string, string|ArrayBuffer|TypedArray|DataView)");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+    if (!str.empty()) {
+        input = sl::io::span<const char>(str.data(), str.length());
+    }
+    try {
+        auto name = jsval_to_string(args[1]);
+        auto data = std::vector<char>(input.data(), input.data() + input.size());
+        auto version = shared_store().publish(name, std::move(data));
+        JsValueRef res = JS_INVALID_REFERENCE;
+        JsDoubleToNumber(static_cast<double>(version), std::addressof(res));
+        return res;
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nShared store publish error");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+void read_native_arg(JsValueRef val, wilton_chakra_value& out, std::string& str_buf) {
+    JsValueType vt = JsUndefined;
+    auto err_type = JsGetValueType(val, std::addressof(vt));
+    if (JsNoError != err_type) throw support::exception(TRACEMSG(
+            "'JsGetValueType' error, code: [" + sl::support::to_string(err_type) + "]"));
+    auto err = JsNoError;
+    switch (vt) {
+    case JsUndefined:
+        out.type = WILTON_CHAKRA_TYPE_UNDEFINED;
+        break;
+    case JsNull:
+        out.type = WILTON_CHAKRA_TYPE_NULL;
+        break;
+    case JsBoolean: {
+        bool bval = false;
+        err = JsBooleanToBool(val, std::addressof(bval));
+        out.type = WILTON_CHAKRA_TYPE_BOOLEAN;
+        out.boolean_value = bval ? 1 : 0;
+        break;
+    }
+    case JsNumber:
+        err = JsNumberToDouble(val, std::addressof(out.number_value));
+        out.type = WILTON_CHAKRA_TYPE_NUMBER;
+        break;
+    case JsString:
+        err = copy_string(val, str_buf);
+        out.type = WILTON_CHAKRA_TYPE_STRING;
+        out.data = const_cast<char*>(str_buf.c_str());
+        out.data_len = static_cast<int>(str_buf.length());
+        break;
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    case JsArrayBuffer: case JsTypedArray: case JsDataView: {
+        auto span = sl::io::span<const char>(nullptr, 0);
+        err = binary_storage(val, span);
+        out.type = WILTON_CHAKRA_TYPE_BINARY;
+        out.data = const_cast<char*>(span.data());
+        out.data_len = static_cast<int>(span.size());
+        break;
+    }
+#endif // WILTON_CHAKRA_CHAKRACORE
+    default:
+        throw support::exception(TRACEMSG("Unsupported argument type: [" + sl::support::to_string(vt) + "]"));
+    }
+    if (JsNoError != err) throw support::exception(TRACEMSG(
+            "Error reading argument, code: [" + sl::support::to_string(err) + "]"));
+}
+
+// result data ownership is taken
+JsValueRef create_native_result(engine_state& st, wilton_chakra_value& result) {
+    auto data = result.data;
+    auto deferred = sl::support::defer([&data] () STATICLIB_NOEXCEPT {
+        if (nullptr != data) {
+            wilton_free(data);
+        }
+    });
+    if (result.data_len < 0) throw support::exception(TRACEMSG(
+            "Invalid result data length: [" + sl::support::to_string(result.data_len) + "]"));
+    if (nullptr == data && result.data_len > 0) throw support::exception(TRACEMSG(
+            "Null result data specified, length: [" + sl::support::to_string(result.data_len) + "]"));
+    JsValueRef res = JS_INVALID_REFERENCE;
+    auto err = JsNoError;
+    switch (result.type) {
+    case WILTON_CHAKRA_TYPE_UNDEFINED:
+        err = JsGetUndefinedValue(std::addressof(res));
+        break;
+    case WILTON_CHAKRA_TYPE_NULL:
+        err = JsGetNullValue(std::addressof(res));
+        break;
+    case WILTON_CHAKRA_TYPE_BOOLEAN:
+        err = JsBoolToBoolean(0 != result.boolean_value, std::addressof(res));
+        break;
+    case WILTON_CHAKRA_TYPE_NUMBER:
+        err = JsDoubleToNumber(result.number_value, std::addressof(res));
+        break;
+    case WILTON_CHAKRA_TYPE_STRING: {
+        auto len = nullptr != data ? static_cast<size_t>(result.data_len) : 0;
+        err = create_string({const_cast<const char*>(nullptr != data ? data : ""), len},
+                st.wbuf, std::addressof(res));
+        break;
+    }
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    case WILTON_CHAKRA_TYPE_BINARY:
+        if (nullptr == data) {
+            err = JsCreateArrayBuffer(0, std::addressof(res));
+            break;
+        }
+        // not copied, buffer is freed by GC
+        err = JsCreateExternalArrayBuffer(data, static_cast<unsigned int>(result.data_len),
+                release_wilton_buffer, data, std::addressof(res));
+        if (JsNoError == err) {
+            data = nullptr;
+        }
+        break;
+#endif // WILTON_CHAKRA_CHAKRACORE
+    default:
+        throw support::exception(TRACEMSG("Unsupported result type: [" + sl::support::to_string(result.type) + "]"));
+    }
+    if (JsNoError != err) throw support::exception(TRACEMSG(
+            "Error creating result, code: [" + sl::support::to_string(err) + "]"));
+    return res;
+}
+
+JsValueRef CALLBACK native_function_trampoline(JsValueRef /* callee */, bool /* is_construct_call */,
+        JsValueRef* args, unsigned short args_count, void* callback_state) STATICLIB_NOEXCEPT {
+    auto nb = static_cast<native_binding*>(callback_state);
+    try {
+        // first argument is 'this'
+        auto count = args_count > 0 ? static_cast<size_t>(args_count - 1) : 0;
+        auto vals = std::vector<wilton_chakra_value>();
+        vals.resize(count);
+        // string arguments are copied, binary ones point to the engine storage
+        auto strings = std::vector<std::string>();
+        strings.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            std::memset(std::addressof(vals[i]), '\0', sizeof(wilton_chakra_value));
+            read_native_arg(args[i + 1], vals[i], strings[i]);
+        }
+        auto result = wilton_chakra_value();
+        std::memset(std::addressof(result), '\0', sizeof(result));
+        auto err = nb->fun->fun(nb->fun->ctx, vals.data(), static_cast<int>(count), std::addressof(result));
+        if (nullptr != err) {
+            if (nullptr != result.data) {
+                wilton_free(result.data);
+            }
+            auto msg = TRACEMSG(err + "\nNative function error, name: [" + nb->fun->name + "]");
+            wilton_free(err);
+            throw support::exception(msg);
+        }
+        return create_native_result(*nb->state, result);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError calling native function, name: [" + nb->fun->name + "]");
+        auto err = create_error(msg);
+        JsSetException(err);
+        return JS_INVALID_REFERENCE;
+    }
+}
+
+// must be called with this context set as current
+void install_native_functions(engine_state& st, context_state& cs) {
+    auto& registry = *st.natives;
+    if (registry.count() > st.native_bindings.size()) {
+        for (auto& fun : registry.list(st.native_bindings.size())) {
+            st.native_bindings.emplace_back(sl::support::make_unique<native_binding>(std::addressof(st), fun));
+        }
+    }
+    for (; cs.native_functions_installed < st.native_bindings.size(); cs.native_functions_installed++) {
+        auto& nb = *st.native_bindings[cs.native_functions_installed];
+        register_c_func(cs.global, nb.fun->name, native_function_trampoline, std::addressof(nb));
+    }
+}
+
+} // namespace
+
+class chakra_engine::impl : public sl::pimpl::object::impl {
+    JsRuntimeHandle runtime = JS_INVALID_RUNTIME_HANDLE;
+    engine_state state;
+    // first entry is the default context
+    std::vector<std::unique_ptr<context_state>> contexts;
+    // kept only when named contexts are enabled
+    std::string init_code;
+    uint32_t max_named_contexts;
+    std::shared_ptr<chakra_memory_stats> memstats;
+    uint32_t call_timeout_millis = 0;
+    // resolved at init if the default timeout is set,
+    // otherwise on the first call with a timeout
+    std::shared_ptr<chakra_watchdog> call_watchdog;
+
+    // idle processing, JsIdle is called only after some work was done
+    bool idle_processing = false;
+    bool idle_pending = false;
+    std::chrono::steady_clock::time_point next_idle;
+    size_t usage_after_last_gc = 0;
+
+    // recycling baseline, taken after init
+    uint64_t top_level_calls = 0;
+    uint64_t created_millis = 0;
+    size_t usage_after_init = 0;
+    // set by the recycling check, collection is done by the GC scheduler
+    bool memory_check_pending = false;
+
+public:
+    ~impl() STATICLIB_NOEXCEPT {
+        dispose();
+    }
+    
+    impl(sl::io::span<const char> init_code_span) {
+        auto cfg = get_config();
+        engine_log_info(state, "wilton.engine.chakra.init", std::string() + "Initializing engine instance," +
+                " config: [" + cfg.to_json().dumps() + "]");
+        auto attrs = create_attributes(cfg);
+        engine_log_info(state, "wilton.engine.chakra.init", "Initializing engine instance ...");
+        auto err_runtime = create_runtime(attrs, std::addressof(this->runtime));
+        if (JsNoError != err_runtime) throw support::exception(TRACEMSG(
+                "'JsCreateRuntime' error, code: [" + sl::support::to_string(err_runtime) + "]"));
+        // destructor is not called if constructor fails
+        try {
+            init(cfg, init_code_span);
+            if (cfg.warmup_iterations > 0) {
+                warmup(cfg);
+            }
+            this->created_millis = monotonic_millis();
+            JsGetRuntimeMemoryUsage(runtime, std::addressof(usage_after_init));
+        } catch (...) {
+            dispose();
+            throw;
+        }
+        engine_log_info(state, "wilton.engine.chakra.init", "Engine initialization complete");
+    }
+
+    support::buffer run_callback_script(chakra_engine& frontend, sl::io::span<const char> callback_script_json) {
+        return run_callback_script_with_options(frontend, callback_script_json, chakra_call_options());
+    }
+
+    support::buffer run_callback_script_with_options(chakra_engine&, sl::io::span<const char> callback_script_json,
+            const chakra_call_options& options) {
+        auto debug = state.run_log.is_enabled();
+        if (debug) {
+            engine_log_debug(state, state.run_log.name(),
+                    "Running callback script: [" + std::string(callback_script_json.data(), callback_script_json.size()) + "]," +
+                    " context: [" + options.context + "] ...");
+        }
+        auto& cs = find_js_context(options.context);
+        context_scope scope(cs.ctx);
+        state.call_depth += 1;
+        auto deferred = sl::support::defer([this] () STATICLIB_NOEXCEPT {
+            this->state.call_depth -= 1;
+        });
+        // nested calls are covered by the outermost call deadline
+        auto timeout = options.timeout_millis > 0 ? options.timeout_millis : call_timeout_millis;
+        auto start = std::chrono::steady_clock::now();
+        auto call_timeout = 1 == state.call_depth ? timeout : 0;
+        watchdog_scope watchdog(runtime, resolve_watchdog(call_timeout), call_timeout);
+        profiler_scope profiling(state, runtime, 1 == state.call_depth);
+        if (1 == state.call_depth) {
+            memstats->set_thread(std::this_thread::get_id());
+            check_soft_memory_limit();
+            sync_native_functions();
+        }
+        auto fun = resolve_wilton_run(cs);
+        auto cc = call_wilton_run(cs, fun, callback_script_json);
+        if (debug) {
+            engine_log_debug(state, state.run_log.name(),
+                    "Callback run complete, result: [" + sl::support::to_string_bool(JsNoError == cc.err) + "]");
+        }
+        if (JsNoError != cc.err) {
+            auto trace = format_stack_trace(state, cc.err);
+            // work queued by the failed call must not run in the next one
+            auto timed_out = 1 == state.call_depth ?
+                    finish_top_level_call(watchdog, timeout, start) : watchdog.disarm();
+            if (timed_out) {
+                throw support::exception(TRACEMSG(timeout_message(timeout)));
+            }
+            throw support::exception(TRACEMSG(trace));
+        }
+        auto out_start = std::chrono::steady_clock::now();
+        auto buf = is_string_ref(cc.value) ? string_to_buffer(cc.value) : support::make_null_buffer();
+        cc.stats->marshalling.record(cc.marshalling_micros + micros_since(out_start));
+        if (1 == state.call_depth && finish_top_level_call(watchdog, timeout, start)) {
+            throw support::exception(TRACEMSG(timeout_message(timeout)));
+        }
+        return buf;
+    }
+
+    support::buffer run_callback_script_batch(chakra_engine&, sl::io::span<const char> batch_json,
+            const chakra_call_options& options) {
+        // items are not parsed here, their texts are passed to 'WILTON_run' as is
+        auto items = split_json_array(batch_json);
+        auto debug = state.run_log.is_enabled();
+        if (debug) {
+            engine_log_debug(state, state.run_log.name(), std::string() + "Running callback batch," +
+                    " size: [" + sl::support::to_string(items.size()) + "]," +
+                    " context: [" + options.context + "] ...");
+        }
+        auto& cs = find_js_context(options.context);
+        context_scope scope(cs.ctx);
+        state.call_depth += 1;
+        auto deferred = sl::support::defer([this] () STATICLIB_NOEXCEPT {
+            this->state.call_depth -= 1;
+        });
+        // timeout applies to the whole batch
+        auto timeout = options.timeout_millis > 0 ? options.timeout_millis : call_timeout_millis;
+        auto start = std::chrono::steady_clock::now();
+        auto call_timeout = 1 == state.call_depth ? timeout : 0;
+        watchdog_scope watchdog(runtime, resolve_watchdog(call_timeout), call_timeout);
+        profiler_scope profiling(state, runtime, 1 == state.call_depth);
+        if (1 == state.call_depth) {
+            memstats->set_thread(std::this_thread::get_id());
+            check_soft_memory_limit();
+            sync_native_functions();
+        }
+        auto fun = resolve_wilton_run(cs);
+        pooled_string result_buf(state.buffers);
+        pooled_string out_buf(state.buffers);
+        // results are written directly as JSON text
+        auto& out = out_buf.value;
+        out.push_back('[');
+        for (size_t i = 0; i < items.size(); i++) {
+            if (i > 0) {
+                out.push_back(',');
+            }
+            auto cc = call_wilton_run(cs, fun, items[i]);
+            if (JsNoError != cc.err) {
+                // failed item does not affect the rest of the batch
+                auto trace = format_stack_trace(state, cc.err);
+                // ordinary JS errors keep the batch deadline armed
+                if (watchdog.fired()) {
+                    if (1 == state.call_depth) {
+                        finish_top_level_call(watchdog, timeout, start);
+                    } else {
+                        watchdog.disarm();
+                    }
+                    throw support::exception(TRACEMSG(timeout_message(timeout)));
+                }
+                out.append("{\"error\":");
+                append_json_string(out, {trace.data(), trace.length()});
+                out.push_back('}');
+                if (1 == state.call_depth) {
+                    run_microtasks(state);
+                }
+                continue;
+            }
+            auto out_start = std::chrono::steady_clock::now();
+            if (is_string_ref(cc.value)) {
+                auto err_copy = copy_string(cc.value, result_buf.value);
+                if (JsNoError != err_copy) throw support::exception(TRACEMSG(
+                        "'JsCopyString' error, code: [" + sl::support::to_string(err_copy) + "]"));
+                out.append("{\"result\":");
+                append_json_string(out, {result_buf.value.data(), result_buf.value.length()});
+                out.push_back('}');
+            } else {
+                out.append("{\"result\":null}");
+            }
+            cc.stats->marshalling.record(cc.marshalling_micros + micros_since(out_start));
+            // same ordering of promise jobs as with separate calls
+            if (1 == state.call_depth) {
+                run_microtasks(state);
+            }
+        }
+        if (debug) {
+            engine_log_debug(state, state.run_log.name(), "Callback batch complete");
+        }
+        if (1 == state.call_depth && finish_top_level_call(watchdog, timeout, start)) {
+            throw support::exception(TRACEMSG(timeout_message(timeout)));
+        }
+        out.push_back(']');
+        return support::make_string_buffer(out);
+    }
+
+    void run_garbage_collector(chakra_engine&) {
+        // all contexts share the runtime heap
+        context_scope scope(contexts.front()->ctx);
+        collect_garbage();
+    }
+
+    bool run_idle_collection(chakra_engine&, uint32_t min_idle_millis, uint64_t min_growth_bytes) {
+        if (state.call_depth > 0) {
+            return false;
+        }
+        if (memory_check_pending) {
+            this->memory_check_pending = false;
+            context_scope scope(contexts.front()->ctx);
+            collect_garbage();
+            engine_log_debug(state, "wilton.engine.chakra.memory", std::string() + "Recycling check collection," +
+                    " usage after: [" + sl::support::to_string(usage_after_last_gc) + "]");
+            return true;
+        }
+        auto idle_millis = monotonic_millis() - memstats->last_activity_millis.load(std::memory_order_relaxed);
+        if (idle_millis < min_idle_millis) {
+            return false;
+        }
+        context_scope scope(contexts.front()->ctx);
+        // let the engine finish its own idle work first, it may free enough
+        run_idle_if_due();
+        size_t usage = 0;
+        auto err_usage = JsGetRuntimeMemoryUsage(runtime, std::addressof(usage));
+        if (JsNoError != err_usage || usage < usage_after_last_gc ||
+                usage - usage_after_last_gc < min_growth_bytes) {
+            return false;
+        }
+        collect_garbage();
+        memstats->idle_collections.fetch_add(1, std::memory_order_relaxed);
+        engine_log_debug(state, "wilton.engine.chakra.memory", std::string() + "Idle collection," +
+                " idle millis: [" + sl::support::to_string(idle_millis) + "]," +
+                " usage before: [" + sl::support::to_string(usage) + "]," +
+                " after: [" + sl::support::to_string(usage_after_last_gc) + "]");
+        return true;
+    }
+
+    std::string recycle_reason(chakra_engine&, const chakra_recycle_policy& policy) {
+        if (state.call_depth > 0) {
+            return std::string();
+        }
+        if (policy.max_calls > 0 && top_level_calls >= policy.max_calls) {
+            return "calls";
+        }
+        if (policy.max_age_millis > 0 && monotonic_millis() - created_millis >= policy.max_age_millis) {
+            return "age";
+        }
+        if (policy.max_memory_growth_bytes > 0) {
+            // garbage is not counted as growth, only usage after a collection is checked
+            if (usage_after_last_gc >= usage_after_init + policy.max_memory_growth_bytes) {
+                return "memory";
+            }
+            // collection is not done on the request thread, it is requested at most
+            // once per 'max_memory_growth_bytes' allocated and is run by the GC scheduler
+            size_t usage = 0;
+            auto err_usage = JsGetRuntimeMemoryUsage(runtime, std::addressof(usage));
+            auto baseline = (std::max)(usage_after_init, usage_after_last_gc);
+            if (JsNoError == err_usage && usage >= baseline + policy.max_memory_growth_bytes) {
+                this->memory_check_pending = true;
+            }
+        }
+        return std::string();
+    }
+
+    bool run_event_loop(chakra_engine&, uint32_t timeout_millis) {
+        context_scope scope(contexts.front()->ctx);
+        state.call_depth += 1;
+        auto deferred = sl::support::defer([this] () STATICLIB_NOEXCEPT {
+            this->state.call_depth -= 1;
+        });
+        // nested runs are not allowed, outer loop continues after the nested call returns
+        if (state.call_depth > 1) {
+            return !has_pending_work(state);
+        }
+        watchdog_scope watchdog(runtime, resolve_watchdog(call_timeout_millis), call_timeout_millis);
+        profiler_scope profiling(state, runtime, true);
+        sync_native_functions();
+        auto bounded = timeout_millis > 0 || call_timeout_millis > 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(
+                timeout_millis > 0 && (0 == call_timeout_millis || timeout_millis < call_timeout_millis) ?
+                timeout_millis : call_timeout_millis);
+        auto res = run_event_loop_until(state, bounded, deadline, true);
+        if (watchdog.disarm()) {
+            throw support::exception(TRACEMSG(timeout_message(call_timeout_millis)));
+        }
+        mark_activity();
+        return res;
+    }
+
+private:
+    void init(chakra_config& cfg, sl::io::span<const char> init_code_span) {
+        if (cfg.runtime_memory_limit > 0) {
+            auto err_limit = JsSetRuntimeMemoryLimit(runtime, static_cast<size_t>(cfg.runtime_memory_limit));
+            if (JsNoError != err_limit) throw support::exception(TRACEMSG(
+                    "'JsSetRuntimeMemoryLimit' error, code: [" + sl::support::to_string(err_limit) + "]"));
+        }
+        this->memstats = std::make_shared<chakra_memory_stats>(runtime, cfg.runtime_memory_limit,
+                cfg.runtime_memory_soft_limit);
+        register_memory_stats(memstats);
+        register_callstats(state.callstats);
+        state.profiler = shared_profiler();
+        state.profile = std::make_shared<chakra_profile_shard>(runtime);
+        state.profiler->register_shard(state.profile);
+        if (cfg.log_sink_enabled) {
+            state.log_sink = shared_log_sink(cfg.log_sink_capacity, cfg.log_sink_block_when_full,
+                    cfg.log_sink_flush_interval_millis);
+            state.log_ring = state.log_sink->open_ring();
+        }
+        state.mailbox = std::make_shared<chakra_mailbox>(state.completions, cfg.channel_mailbox_capacity);
+        state.natives = std::addressof(native_registry());
+        if (!cfg.bytecode_cache_dir.empty()) {
+            state.bytecode_cache = shared_bytecode_cache(cfg.bytecode_cache_dir);
+        }
+        auto code = sl::io::span<const char>(init_code_span.data(), std::strlen(init_code_span.data()));
+        this->max_named_contexts = cfg.max_named_contexts;
+        state.async_worker_threads = cfg.async_worker_threads;
+        state.event_loop_max_run_millis = cfg.event_loop_max_run_millis;
+        this->idle_processing = cfg.enable_idle_processing;
+        this->call_timeout_millis = cfg.call_timeout_millis;
+        resolve_watchdog(call_timeout_millis);
+        if (max_named_contexts > 0) {
+            this->init_code = std::string(code.data(), code.size());
+        }
+        create_js_context("", code);
+    }
+
+    // runs the configured callback repeatedly, so hot functions are
+    // compiled by JIT before the engine serves calls
+    void warmup(chakra_config& cfg) {
+        auto jit_enabled = !cfg.disable_native_code_generation && !cfg.disable_executable_page_allocation;
+        if (!jit_enabled) {
+            engine_log_warn(state, "wilton.engine.chakra.init",
+                    "Warmup is requested, but native code generation is disabled");
+        }
+        auto& cs = *contexts.front();
+        context_scope scope(cs.ctx);
+        state.call_depth += 1;
+        auto deferred = sl::support::defer([this] () STATICLIB_NOEXCEPT {
+            this->state.call_depth -= 1;
+        });
+        auto fun = resolve_wilton_run(cs);
+        auto script = sl::io::span<const char>(cfg.warmup_callback_script.data(),
+                cfg.warmup_callback_script.length());
+        auto start = std::chrono::steady_clock::now();
+        uint64_t first_micros = 0;
+        uint64_t last_micros = 0;
+        for (uint32_t i = 0; i < cfg.warmup_iterations; i++) {
+            auto iter_start = std::chrono::steady_clock::now();
+            auto cc = call_wilton_run(cs, fun, script);
+            if (JsNoError != cc.err) throw support::exception(TRACEMSG(format_stack_trace(state, cc.err) +
+                    "\nWarmup error, iteration: [" + sl::support::to_string(i) + "]"));
+            run_promise_jobs(state);
+            last_micros = micros_since(iter_start);
+            if (0 == i) {
+                first_micros = last_micros;
+            }
+        }
+        // interpreter to JIT transition is not reported by jsrt, it is
+        // estimated from the first and last iteration times,
+        // ratio is kept in hundredths to report fractional speedups
+        auto ratio = last_micros > 0 ? first_micros * 100 / last_micros : 0;
+        auto ratio_frac = sl::support::to_string(ratio % 100);
+        if (1 == ratio_frac.length()) {
+            ratio_frac.insert(0, "0");
+        }
+        engine_log_info(state, "wilton.engine.chakra.init", std::string() + "Warmup complete," +
+                " iterations: [" + sl::support::to_string(cfg.warmup_iterations) + "]," +
+                " time millis: [" + sl::support::to_string(micros_since(start) / 1000) + "]," +
+                " first iteration micros: [" + sl::support::to_string(first_micros) + "]," +
+                " last iteration micros: [" + sl::support::to_string(last_micros) + "]," +
+                " speedup: [" + sl::support::to_string(ratio / 100) + "." + ratio_frac + "x]," +
+                " JIT: [" + sl::support::to_string_bool(jit_enabled) + "]");
+    }
+
+    void dispose() STATICLIB_NOEXCEPT {
+        if (nullptr != memstats.get()) {
+            unregister_memory_stats(memstats);
+        }
+        unregister_callstats(state.callstats);
+        if (nullptr != state.profiler.get()) {
+            state.profiler->unregister_shard(state.profile);
+        }
+        if (nullptr != state.log_sink.get()) {
+            state.log_sink->close_ring(state.log_ring);
+            // messages logged after this point are written inline
+            state.log_ring.reset();
+        }
+        if (nullptr != state.mailbox.get()) {
+            channel_registry().unlisten_all(state.mailbox.get());
+        }
+        if (!contexts.empty()) {
+            JsSetCurrentContext(contexts.front()->ctx);
+            release_async_handles(state);
+        }
+        for (auto& cs : contexts) {
+            JsSetCurrentContext(cs->ctx);
+            release_context_handles(*cs);
+        }
+        release_engine_handles(state);
+        JsSetCurrentContext(JS_INVALID_REFERENCE);
+        JsDisableRuntimeExecution(runtime);
+        JsDisposeRuntime(runtime);
+    }
+
+    // collects garbage before the call if usage is above the soft limit,
+    // so the call is less likely to fail on the hard limit
+    void check_soft_memory_limit() {
+        if (0 == memstats->soft_limit) {
+            return;
+        }
+        size_t usage = 0;
+        auto err_usage = JsGetRuntimeMemoryUsage(runtime, std::addressof(usage));
+        if (JsNoError != err_usage || usage <= memstats->soft_limit) {
+            return;
+        }
+        collect_garbage();
+        memstats->soft_limit_collections.fetch_add(1, std::memory_order_relaxed);
+        engine_log_debug(state, "wilton.engine.chakra.memory", std::string() + "Soft limit collection," +
+                " usage before: [" + sl::support::to_string(usage) + "]," +
+                " after: [" + sl::support::to_string(usage_after_last_gc) + "]");
+    }
+
+    // converts callback script to JS string and passes it to 'WILTON_run',
+    // JS time and input conversion time are measured
+    wilton_run_call call_wilton_run(context_state& cs, JsValueRef fun, sl::io::span<const char> callback_script_json) {
+        auto res = wilton_run_call();
+        res.stats = std::addressof(find_callback_stats(callback_script_json));
+        auto marshal_start = std::chrono::steady_clock::now();
+        JsValueRef cb_arg_ref = JS_INVALID_REFERENCE;
+        auto err_arg = create_string(callback_script_json, state.wbuf, std::addressof(cb_arg_ref));
+        if (JsNoError != err_arg) throw support::exception(TRACEMSG(
+                "'JsCreateString' error, code: [" + sl::support::to_string(err_arg) + "]"));
+        auto args = std::array<JsValueRef, 2>();
+        args[0] = cs.null_value;
+        args[1] = cb_arg_ref;
+        auto call_start = std::chrono::steady_clock::now();
+        res.err = JsCallFunction(fun, args.data(), static_cast<unsigned short>(args.size()), std::addressof(res.value));
+        res.stats->js.record(micros_since(call_start));
+        res.marshalling_micros = micros_between(marshal_start, call_start);
+        return res;
+    }
+
+    // drains promise jobs and finished async calls and does idle work, timers
+    // and calls in flight are left to 'run_event_loop', unless the loop is
+    // enabled here with 'event_loop_max_run_millis'; must be called on both
+    // success and error paths of the outermost call, pending promise jobs
+    // of a call interrupted by the watchdog are dropped,
+    // returns true if the call deadline was reached
+    bool finish_top_level_call(watchdog_scope& watchdog, uint32_t timeout,
+            std::chrono::steady_clock::time_point start) {
+        auto max_run = state.event_loop_max_run_millis;
+        if (watchdog.fired()) {
+            drop_promise_jobs(state);
+        } else if (0 == max_run) {
+            run_microtasks(state);
+        } else {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(max_run);
+            auto call_deadline = start + std::chrono::milliseconds(timeout);
+            if (timeout > 0 && call_deadline < deadline) {
+                deadline = call_deadline;
+            }
+            run_event_loop_until(state, true, deadline, false);
+        }
+        auto fired = watchdog.disarm();
+        if (fired) {
+            drop_promise_jobs(state);
+        }
+        mark_activity();
+        run_idle_if_due();
+        return fired;
+    }
+
+    chakra_call_stats& find_callback_stats(sl::io::span<const char> callback_script_json) {
+        pooled_string module_buf(state.buffers);
+        callback_module(callback_script_json, module_buf.value);
+        return state.callstats->callback(module_buf.value);
+    }
+
+    chakra_watchdog* resolve_watchdog(uint32_t timeout_millis) {
+        if (timeout_millis > 0 && nullptr == call_watchdog.get()) {
+            this->call_watchdog = shared_watchdog();
+        }
+        return call_watchdog.get();
+    }
+
+    // installs functions registered after the last call, all contexts are updated together
+    void sync_native_functions() {
+        if (state.natives->count() == state.native_bindings.size()) {
+            return;
+        }
+        for (auto& cs : contexts) {
+            context_scope scope(cs->ctx);
+            install_native_functions(state, *cs);
+        }
+    }
+
+    // full collection, pause time is recorded, usage after
+    // collection is the baseline for idle collections
+    void collect_garbage() {
+        auto start = std::chrono::steady_clock::now();
+        auto err = JsCollectGarbage(runtime);
+        if (JsNoError != err) throw support::exception(TRACEMSG(
+                "'JsCollectGarbage' error, code: [" + sl::support::to_string(err) + "]"));
+        memstats->record_collection(micros_since(start));
+        size_t usage = 0;
+        if (JsNoError == JsGetRuntimeMemoryUsage(runtime, std::addressof(usage))) {
+            this->usage_after_last_gc = usage;
+        }
+    }
+
+    void mark_activity() {
+        this->top_level_calls += 1;
+        memstats->last_activity_millis.store(monotonic_millis(), std::memory_order_relaxed);
+        if (idle_processing && !idle_pending) {
+            this->idle_pending = true;
+            this->next_idle = std::chrono::steady_clock::now();
+        }
+    }
+
+    // gives the engine a chance to do incremental GC and to
+    // release JIT memory, context must be set by the caller
+    void run_idle_if_due() {
+        if (!idle_pending || std::chrono::steady_clock::now() < next_idle) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        unsigned int next_tick = 0;
+        auto err = JsIdle(std::addressof(next_tick));
+        memstats->record_idle_call(micros_since(start));
+        if (JsNoError != err) {
+            engine_log_warn(state, "wilton.engine.chakra.memory",
+                    "'JsIdle' error, code: [" + sl::support::to_string(err) + "]");
+            this->idle_pending = false;
+            return;
+        }
+        // no more idle work until next call
+        if ((std::numeric_limits<unsigned int>::max)() == next_tick) {
+            this->idle_pending = false;
+            return;
+        }
+        // tick counter wraps, difference is taken modulo 2^32
+        auto delay = static_cast<int32_t>(static_cast<uint32_t>(next_tick) - platform_tick_millis());
+        delay = (std::min)((std::max)(delay, 0), 10000);
+        this->next_idle = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+    }
+
+    context_state& create_js_context(const std::string& name, sl::io::span<const char> code) {
+        auto cs = sl::support::make_unique<context_state>(name);
+        auto err_ctx = create_context(runtime, std::addressof(cs->ctx));
+        if (JsNoError != err_ctx) throw support::exception(TRACEMSG(
+                "'JsCreateContext' error, code: [" + sl::support::to_string(err_ctx) + "]"));
+        context_scope scope(cs->ctx);
+        if (JS_INVALID_REFERENCE == state.stack_prop) {
+            init_engine_handles(state);
+        }
+        init_context_handles(*cs);
+        // contexts are registered before init code runs, so handles
+        // are released on destruction even if the init fails
+        contexts.emplace_back(std::move(cs));
+        auto& res = *contexts.back();
+        auto err_cont = JsSetPromiseContinuationCallback(promise_continuation, std::addressof(state));
+        if (JsNoError != err_cont) throw support::exception(TRACEMSG(
+                "'JsSetPromiseContinuationCallback' error, code: [" + sl::support::to_string(err_cont) + "]"));
+        register_c_func(res.global, "print", print_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_load", load_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_wiltoncall", wiltoncall_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_wiltoncall_json", wiltoncall_json_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_wiltoncall_lazy", wiltoncall_lazy_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_lazy_get", lazy_get_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_lazy_length", lazy_length_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_lazy_keys", lazy_keys_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_lazy_release", lazy_release_func, std::addressof(state));
+        register_c_func(res.global, "setTimeout", set_timeout_func, std::addressof(state));
+        register_c_func(res.global, "clearTimeout", clear_timer_func, std::addressof(state));
+        register_c_func(res.global, "setImmediate", set_immediate_func, std::addressof(state));
+        register_c_func(res.global, "clearImmediate", clear_timer_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_channel_listen", channel_listen_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_channel_close", channel_close_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_channel_post", channel_post_func, std::addressof(state));
+#ifdef WILTON_CHAKRA_CHAKRACORE
+        register_c_func(res.global, "WILTON_wiltoncall_bin", wiltoncall_bin_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_wiltoncall_async", wiltoncall_async_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_sharedStore_get", shared_store_get_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_sharedStore_version", shared_store_version_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_sharedStore_publish", shared_store_publish_func, std::addressof(state));
+        register_c_func(res.global, "WILTON_channel_allocate", channel_allocate_func, std::addressof(state));
+#endif // WILTON_CHAKRA_CHAKRACORE
+        install_native_functions(state, res);
+        eval_init_code(state, code);
+        return res;
+    }
+
+    context_state& find_js_context(const std::string& name) {
+        for (auto& cs : contexts) {
+            if (name == cs->name) {
+                return *cs;
+            }
+        }
+        auto named_count = static_cast<uint32_t>(contexts.size() - 1);
+        if (named_count >= max_named_contexts) throw support::exception(TRACEMSG(
+                "Named contexts limit exceeded, context: [" + name + "]," +
+                " limit: [" + sl::support::to_string(max_named_contexts) + "]"));
+        engine_log_info(state, "wilton.engine.chakra.init", "Creating context: [" + name + "] ...");
+        auto code = sl::io::span<const char>(init_code.data(), init_code.length());
+        try {
+            return create_js_context(name, code);
+        } catch (const std::exception&) {
+            // half-initialized context is not reused
+            if (contexts.size() > 1 && name == contexts.back()->name) {
+                context_scope scope(contexts.back()->ctx);
+                release_context_handles(*contexts.back());
+                contexts.pop_back();
+            }
+            throw;
+        }
+    }
+
+    JsValueRef resolve_wilton_run(context_state& cs) {
+        JsValueRef fun = JS_INVALID_REFERENCE;
+        auto err_get = JsGetProperty(cs.global, state.wilton_run_prop, std::addressof(fun));
+        if (JsNoError != err_get) throw support::exception(TRACEMSG(
+                "'JsGetProperty' error, code: [" + sl::support::to_string(err_get) + "]"));
+        if (fun == cs.wilton_run_fun) {
+            return fun;
+        }
+        // first call or global binding was replaced
+        JsValueType fun_type = JsUndefined;
+        auto err_type = JsGetValueType(fun, std::addressof(fun_type));
+        if (JsNoError != err_type) throw support::exception(TRACEMSG(
+                "'JsGetValueType' error, code: [" + sl::support::to_string(err_type) + "]"));
+        if (JsFunction != fun_type) throw support::exception(TRACEMSG(
+                "Error accessing 'WILTON_run' function: not a function"));
+        add_ref(fun, "WILTON_run");
+        if (JS_INVALID_REFERENCE != cs.wilton_run_fun) {
+            JsRelease(cs.wilton_run_fun, nullptr);
+        }
+        cs.wilton_run_fun = fun;
+        return fun;
     }
 };
 
 PIMPL_FORWARD_CONSTRUCTOR(chakra_engine, (sl::io::span<const char>), (), support::exception)
 PIMPL_FORWARD_METHOD(chakra_engine, support::buffer, run_callback_script, (sl::io::span<const char>), (), support::exception)
+PIMPL_FORWARD_METHOD(chakra_engine, support::buffer, run_callback_script_with_options, (sl::io::span<const char>)(const chakra_call_options&), (), support::exception)
+PIMPL_FORWARD_METHOD(chakra_engine, support::buffer, run_callback_script_batch, (sl::io::span<const char>)(const chakra_call_options&), (), support::exception)
 PIMPL_FORWARD_METHOD(chakra_engine, void, run_garbage_collector, (), (), support::exception)
+PIMPL_FORWARD_METHOD(chakra_engine, bool, run_event_loop, (uint32_t), (), support::exception)
+PIMPL_FORWARD_METHOD(chakra_engine, bool, run_idle_collection, (uint32_t)(uint64_t), (), support::exception)
+PIMPL_FORWARD_METHOD(chakra_engine, std::string, recycle_reason, (const chakra_recycle_policy&), (), support::exception)
 
 } // namespace
 }
@@ -24,6 +24,7 @@
 #ifndef WILTON_CHAKRA_ENGINE_HPP
 #define WILTON_CHAKRA_ENGINE_HPP
 
+#include <cstdint>
 #include <string>
 
 #include "staticlib/json.hpp"
@@ -36,6 +37,32 @@
 namespace wilton {
 namespace chakra {
 
+/**
+ * Per-call settings
+ */
+struct chakra_call_options {
+    // empty string for the default context
+    std::string context;
+    // zero to use the configured default timeout
+    uint32_t timeout_millis = 0;
+};
+
+/**
+ * Limits after which engine is replaced with a new one,
+ * zero values disable the corresponding check
+ */
+struct chakra_recycle_policy {
+    // top-level calls since init
+    uint32_t max_calls = 0;
+    // heap growth since init, checked after collection
+    uint64_t max_memory_growth_bytes = 0;
+    uint32_t max_age_millis = 0;
+
+    bool enabled() const {
+        return max_calls > 0 || max_memory_growth_bytes > 0 || max_age_millis > 0;
+    }
+};
+
 class chakra_engine : public sl::pimpl::object {
 protected:
     /**
@@ -54,7 +81,63 @@ public:
     
     support::buffer run_callback_script(sl::io::span<const char> callback_script_json);
 
+    /**
+     * Runs callback script in a named context, contexts share the engine
+     * runtime (heap and JIT), but have separate sets of globals;
+     * missing context is created on first use; script that runs longer
+     * than the timeout is interrupted, engine stays usable after that
+     * 
+     * @param callback_script_json callback script
+     * @param options context name and timeout
+     * @return callback result
+     */
+    support::buffer run_callback_script_with_options(sl::io::span<const char> callback_script_json,
+            const chakra_call_options& options);
+
+    /**
+     * Runs multiple callback scripts with a single engine entry,
+     * error in one callback does not stop the rest of the batch;
+     * timeout applies to the whole batch
+     * 
+     * @param batch_json JSON array of callback scripts
+     * @param options context name and timeout
+     * @return JSON array with either {"result": ...} or {"error": "..."} for each callback
+     */
+    support::buffer run_callback_script_batch(sl::io::span<const char> batch_json,
+            const chakra_call_options& options);
+
     void run_garbage_collector();
+
+    /**
+     * Runs pending promise jobs, timers and async call completions
+     * 
+     * @param timeout_millis max time to run, zero to run until idle
+     * @return true if no pending work is left
+     */
+    bool run_event_loop(uint32_t timeout_millis);
+
+    /**
+     * Collects garbage if the engine was idle long enough and its heap
+     * has grown since the last collection, or if the collection was
+     * requested by the memory growth recycling check; must not be called
+     * concurrently with other calls on this engine
+     * 
+     * @param min_idle_millis min time since the last call
+     * @param min_growth_bytes min heap growth since the last collection
+     * @return true if collection was done
+     */
+    bool run_idle_collection(uint32_t min_idle_millis, uint64_t min_growth_bytes);
+
+    /**
+     * Checks whether the engine has reached any of the recycling limits,
+     * does not collect garbage, memory growth is confirmed by a collection
+     * requested from 'run_idle_collection'; must not be called
+     * concurrently with other calls on this engine
+     * 
+     * @param policy recycling limits
+     * @return reason ("calls", "memory" or "age"), empty string if engine can be used further
+     */
+    std::string recycle_reason(const chakra_recycle_policy& policy);
 };
 
 } // namespace
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_engine_map.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 3:45 PM
+ */
+
+#include "chakra_engine_map.hpp"
+
+#include <vector>
+
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace chakra {
+
+chakra_engine_map::chakra_engine_map(std::string&& init_code_str,
+        std::shared_ptr<chakra_engine_recycler> engine_recycler) :
+init_code(std::move(init_code_str)),
+recycler(std::move(engine_recycler)) { }
+
+support::buffer chakra_engine_map::run(std::function<support::buffer(chakra_engine&)> fun) {
+    auto en = thread_local_entry();
+    std::lock_guard<std::recursive_mutex> guard{en->mutex};
+    auto outermost = 0 == en->depth;
+    if (outermost && nullptr != en->pending.get()) {
+        recycler->swap_if_ready(en->pending, en->engine);
+    }
+    en->depth += 1;
+    auto deferred = sl::support::defer([&en] () STATICLIB_NOEXCEPT {
+        en->depth -= 1;
+    });
+    auto res = fun(*en->engine);
+    if (outermost && nullptr != recycler.get() && nullptr == en->pending.get()) {
+        en->pending = recycler->check(*en->engine);
+    }
+    return res;
+}
+
+void chakra_engine_map::clean_thread_local(const char* thread_id, int thread_id_len) {
+    auto tid = std::string(thread_id, static_cast<size_t>(thread_id_len));
+    auto en = std::shared_ptr<entry>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (auto it = engines.begin(); it != engines.end(); ++it) {
+            if (tid == sl::support::to_string_any(it->first)) {
+                en = std::move(it->second);
+                engines.erase(it);
+                break;
+            }
+        }
+    }
+    // engine is destroyed outside of the lock
+    if (nullptr != en.get()) {
+        // wait for maintenance to finish
+        std::lock_guard<std::recursive_mutex> guard{en->mutex};
+    }
+}
+
+void chakra_engine_map::for_each_idle_engine(std::function<void(chakra_engine&)> fun) {
+    auto list = std::vector<std::shared_ptr<entry>>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (auto& pa : engines) {
+            list.push_back(pa.second);
+        }
+    }
+    for (auto& en : list) {
+        std::unique_lock<std::recursive_mutex> guard{en->mutex, std::try_to_lock};
+        if (guard.owns_lock()) {
+            fun(*en->engine);
+        }
+    }
+}
+
+std::shared_ptr<chakra_engine_map::entry> chakra_engine_map::thread_local_entry() {
+    auto tid = std::this_thread::get_id();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = engines.find(tid);
+        if (engines.end() != it) {
+            return it->second;
+        }
+    }
+    // engine init is slow, other threads are not blocked
+    auto code = sl::io::span<const char>(init_code.data(), init_code.length());
+    auto en = std::make_shared<entry>(std::make_shared<chakra_engine>(code));
+    std::lock_guard<std::mutex> guard{mutex};
+    engines.insert(std::make_pair(tid, en));
+    return en;
+}
+
+} // namespace
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_engine_map.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 3:40 PM
+ */
+
+#ifndef WILTON_CHAKRA_ENGINE_MAP_HPP
+#define WILTON_CHAKRA_ENGINE_MAP_HPP
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "wilton/support/buffer.hpp"
+#include "wilton/support/exception.hpp"
+
+#include "chakra_engine.hpp"
+#include "chakra_engine_recycler.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Thread-local engines, engine is created on the first call
+ * made from a thread and destroyed by the TLS cleaner
+ */
+class chakra_engine_map {
+    // engine mutex is held by the owner thread for the duration of the call
+    // (recursively for nested calls), maintenance only tries to lock it
+    struct entry {
+        std::shared_ptr<chakra_engine> engine;
+        std::recursive_mutex mutex;
+        // guarded by engine mutex, engine is swapped only between outermost calls
+        uint32_t depth = 0;
+        std::shared_ptr<chakra_engine_recycler::replacement> pending;
+
+        entry(std::shared_ptr<chakra_engine> engine_ptr) :
+        engine(std::move(engine_ptr)) { }
+    };
+
+    std::string init_code;
+    std::shared_ptr<chakra_engine_recycler> recycler;
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, std::shared_ptr<entry>> engines;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param init_code engine init script
+     * @param recycler engine recycler, may be empty
+     */
+    chakra_engine_map(std::string&& init_code, std::shared_ptr<chakra_engine_recycler> recycler);
+
+    chakra_engine_map(const chakra_engine_map&) = delete;
+
+    chakra_engine_map& operator=(const chakra_engine_map&) = delete;
+
+    support::buffer run(std::function<support::buffer(chakra_engine&)> fun);
+
+    void clean_thread_local(const char* thread_id, int thread_id_len);
+
+    /**
+     * Runs the specified function with every engine that is not
+     * running a call at the moment, busy engines are skipped
+     *
+     * @param fun function to run
+     */
+    void for_each_idle_engine(std::function<void(chakra_engine&)> fun);
+
+private:
+    std::shared_ptr<entry> thread_local_entry();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_ENGINE_MAP_HPP */
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_engine_pool.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 2:45 PM
+ */
+
+#include "chakra_engine_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.pool");
+
+uint64_t micros_since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+} // namespace
+
+chakra_engine_pool::chakra_engine_pool(std::string&& init_code_str, uint32_t pool_size,
+        uint32_t borrow_timeout, uint32_t max_waiting,
+        std::shared_ptr<chakra_engine_recycler> engine_recycler) :
+init_code(std::move(init_code_str)),
+borrow_timeout_millis(borrow_timeout),
+max_waiters(max_waiting),
+recycler(std::move(engine_recycler)) {
+    wilton::support::log_info(logger, "Initializing engine pool, size: [" +
+            sl::support::to_string(pool_size) + "] ...");
+    auto start = std::chrono::steady_clock::now();
+    auto engines = std::vector<std::shared_ptr<chakra_engine>>();
+    engines.resize(pool_size);
+    auto errors = std::vector<std::string>();
+    errors.resize(pool_size);
+    auto threads = std::vector<std::thread>();
+    auto code = sl::io::span<const char>(init_code.data(), init_code.length());
+    for (uint32_t i = 0; i < pool_size; i++) {
+        auto engine_ptr = std::addressof(engines[i]);
+        auto error_ptr = std::addressof(errors[i]);
+        threads.emplace_back([engine_ptr, error_ptr, code] {
+            try {
+                *engine_ptr = std::make_shared<chakra_engine>(code);
+            } catch (const std::exception& e) {
+                *error_ptr = e.what();
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (auto& err : errors) {
+        if (!err.empty()) {
+            throw support::exception(TRACEMSG(err + "\nError initializing engine pool"));
+        }
+    }
+    this->idle = std::move(engines);
+    this->size = pool_size;
+    wilton::support::log_info(logger, "Engine pool initialized, time millis: [" +
+            sl::support::to_string(micros_since(start) / 1000) + "]");
+}
+
+support::buffer chakra_engine_pool::run(std::function<support::buffer(chakra_engine&)> fun) {
+    auto nested = false;
+    auto engine = borrow(nested);
+    if (nested) {
+        return fun(*engine);
+    }
+    auto deferred = sl::support::defer([this, engine] () STATICLIB_NOEXCEPT {
+        this->give_back(engine);
+    });
+    auto res = fun(*engine);
+    if (nullptr != recycler.get()) {
+        check_recycle(engine);
+    }
+    return res;
+}
+
+sl::json::value chakra_engine_pool::stats() {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto avg = borrow_count > 0 ? borrow_wait_total_micros / borrow_count : 0;
+    return {
+        { "size", size },
+        { "idle", static_cast<uint32_t>(idle.size()) },
+        { "inUse", static_cast<uint32_t>(borrowed.size()) },
+        { "peakInUse", peak_in_use },
+        { "waiting", waiting },
+        { "peakWaiting", peak_waiting },
+        { "borrowCount", borrow_count },
+        { "borrowWaitAvgMicros", avg },
+        { "borrowWaitMaxMicros", borrow_wait_max_micros },
+        { "timeoutCount", timeout_count },
+        { "rejectedCount", rejected_count }
+    };
+}
+
+void chakra_engine_pool::for_each_idle_engine(std::function<void(chakra_engine&)> fun) {
+    auto list = std::vector<std::shared_ptr<chakra_engine>>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        list = idle;
+    }
+    for (auto& engine : list) {
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = std::find(idle.begin(), idle.end(), engine);
+            if (idle.end() == it) {
+                // borrowed meanwhile
+                continue;
+            }
+            idle.erase(it);
+        }
+        auto deferred = sl::support::defer([this, &engine] () STATICLIB_NOEXCEPT {
+            {
+                std::lock_guard<std::mutex> guard{this->mutex};
+                // least recently used engines are kept in front
+                this->idle.insert(this->idle.begin(), engine);
+            }
+            this->cv.notify_one();
+        });
+        fun(*engine);
+    }
+}
+
+std::shared_ptr<chakra_engine> chakra_engine_pool::borrow(bool& nested) {
+    auto tid = std::this_thread::get_id();
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> guard{mutex};
+    auto it = borrowed.find(tid);
+    if (borrowed.end() != it) {
+        nested = true;
+        return it->second;
+    }
+    if (idle.empty()) {
+        if (max_waiters > 0 && waiting >= max_waiters) {
+            rejected_count += 1;
+            throw support::exception(TRACEMSG("Engine pool wait queue is full," +
+                    " waiting threads: [" + sl::support::to_string(waiting) + "]"));
+        }
+        waiting += 1;
+        if (waiting > peak_waiting) {
+            peak_waiting = waiting;
+        }
+        auto available = cv.wait_for(guard, std::chrono::milliseconds(borrow_timeout_millis), [this] {
+            return !this->idle.empty();
+        });
+        waiting -= 1;
+        if (!available) {
+            timeout_count += 1;
+            throw support::exception(TRACEMSG("Timeout waiting for a free engine," +
+                    " timeout millis: [" + sl::support::to_string(borrow_timeout_millis) + "]"));
+        }
+    }
+    auto engine = std::move(idle.back());
+    idle.pop_back();
+    borrowed.insert(std::make_pair(tid, engine));
+    auto in_use = static_cast<uint32_t>(borrowed.size());
+    if (in_use > peak_in_use) {
+        peak_in_use = in_use;
+    }
+    auto wait = micros_since(start);
+    borrow_count += 1;
+    borrow_wait_total_micros += wait;
+    if (wait > borrow_wait_max_micros) {
+        borrow_wait_max_micros = wait;
+    }
+    return engine;
+}
+
+void chakra_engine_pool::give_back(std::shared_ptr<chakra_engine> engine) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        borrowed.erase(std::this_thread::get_id());
+        auto it = pending.find(engine.get());
+        if (pending.end() != it) {
+            auto key = it->first;
+            recycler->swap_if_ready(it->second, engine);
+            if (nullptr == it->second.get()) {
+                pending.erase(key);
+            }
+        }
+        idle.emplace_back(std::move(engine));
+    }
+    cv.notify_one();
+}
+
+void chakra_engine_pool::check_recycle(const std::shared_ptr<chakra_engine>& engine) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (pending.end() != pending.find(engine.get())) {
+            return;
+        }
+    }
+    // engine is still borrowed by this thread
+    auto rep = recycler->check(*engine);
+    if (nullptr != rep.get()) {
+        std::lock_guard<std::mutex> guard{mutex};
+        pending.insert(std::make_pair(engine.get(), std::move(rep)));
+    }
+}
+
+} // namespace
+}
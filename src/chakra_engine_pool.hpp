@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_engine_pool.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 2:30 PM
+ */
+
+#ifndef WILTON_CHAKRA_ENGINE_POOL_HPP
+#define WILTON_CHAKRA_ENGINE_POOL_HPP
+
+#include <cstdint>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+
+#include "wilton/support/buffer.hpp"
+#include "wilton/support/exception.hpp"
+
+#include "chakra_engine.hpp"
+#include "chakra_engine_recycler.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Fixed-size set of engines shared by all threads, engine is borrowed
+ * for the duration of a single call; nested calls made from JS code
+ * reuse the engine already borrowed by the calling thread
+ */
+class chakra_engine_pool {
+    std::string init_code;
+    uint32_t borrow_timeout_millis;
+    uint32_t max_waiters;
+    std::shared_ptr<chakra_engine_recycler> recycler;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<chakra_engine>> idle;
+    std::unordered_map<std::thread::id, std::shared_ptr<chakra_engine>> borrowed;
+    // engines are swapped with their replacements when given back
+    std::unordered_map<chakra_engine*, std::shared_ptr<chakra_engine_recycler::replacement>> pending;
+
+    // metrics, guarded by mutex
+    uint32_t size = 0;
+    uint32_t waiting = 0;
+    uint32_t peak_waiting = 0;
+    uint32_t peak_in_use = 0;
+    uint64_t borrow_count = 0;
+    uint64_t borrow_wait_total_micros = 0;
+    uint64_t borrow_wait_max_micros = 0;
+    uint64_t timeout_count = 0;
+    uint64_t rejected_count = 0;
+
+public:
+    /**
+     * Creates all engines in parallel, one thread per engine
+     *
+     * @param init_code engine init script
+     * @param pool_size number of engines
+     * @param borrow_timeout_millis max time to wait for a free engine
+     * @param max_waiters max number of waiting threads, zero for unbounded
+     * @param recycler engine recycler, may be empty
+     */
+    chakra_engine_pool(std::string&& init_code, uint32_t pool_size,
+            uint32_t borrow_timeout_millis, uint32_t max_waiters,
+            std::shared_ptr<chakra_engine_recycler> recycler);
+
+    chakra_engine_pool(const chakra_engine_pool&) = delete;
+
+    chakra_engine_pool& operator=(const chakra_engine_pool&) = delete;
+
+    /**
+     * Runs the specified function with an engine borrowed by the calling thread
+     *
+     * @param fun function to run
+     * @return function result
+     */
+    support::buffer run(std::function<support::buffer(chakra_engine&)> fun);
+
+    sl::json::value stats();
+
+    /**
+     * Runs the specified function with every idle engine, engine
+     * is taken from the idle list for the duration of the function
+     *
+     * @param fun function to run
+     */
+    void for_each_idle_engine(std::function<void(chakra_engine&)> fun);
+
+private:
+    std::shared_ptr<chakra_engine> borrow(bool& nested);
+
+    void give_back(std::shared_ptr<chakra_engine> engine);
+
+    void check_recycle(const std::shared_ptr<chakra_engine>& engine);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_ENGINE_POOL_HPP */
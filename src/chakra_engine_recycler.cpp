@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_engine_recycler.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 1:30 PM
+ */
+
+#include "chakra_engine_recycler.hpp"
+
+#include "staticlib/io.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.recycler");
+
+uint64_t micros_since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+} // namespace
+
+chakra_engine_recycler::chakra_engine_recycler(const chakra_recycle_policy& policy, std::string&& init_code_str) :
+recycle_policy(policy),
+init_code(std::move(init_code_str)) {
+    wilton::support::log_info(logger, std::string() + "Starting engine recycler thread," +
+            " max calls: [" + sl::support::to_string(policy.max_calls) + "]," +
+            " max memory growth bytes: [" + sl::support::to_string(policy.max_memory_growth_bytes) + "]," +
+            " max age millis: [" + sl::support::to_string(policy.max_age_millis) + "]");
+    this->worker = std::thread([this] {
+        this->run();
+    });
+}
+
+chakra_engine_recycler::~chakra_engine_recycler() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+std::shared_ptr<chakra_engine_recycler::replacement> chakra_engine_recycler::check(chakra_engine& engine) {
+    auto reason = engine.recycle_reason(recycle_policy);
+    if (reason.empty()) {
+        return std::shared_ptr<replacement>();
+    }
+    auto rep = std::make_shared<replacement>(reason);
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        builds.push_back(rep);
+        scheduled_count += 1;
+    }
+    cv.notify_one();
+    wilton::support::log_info(logger, "Engine recycling requested, reason: [" + reason + "]");
+    return rep;
+}
+
+void chakra_engine_recycler::swap_if_ready(std::shared_ptr<replacement>& pending,
+        std::shared_ptr<chakra_engine>& engine) {
+    auto fresh = std::shared_ptr<chakra_engine>();
+    auto error = std::string();
+    {
+        std::lock_guard<std::mutex> guard{pending->mutex};
+        if (!pending->done) {
+            return;
+        }
+        fresh = std::move(pending->engine);
+        error = pending->error;
+    }
+    auto reason = pending->reason;
+    auto wait = micros_since(pending->requested);
+    pending.reset();
+    if (nullptr == fresh.get()) {
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            failed_count += 1;
+        }
+        // engine is kept, replacement is requested again on the next check
+        wilton::support::log_error(logger, "Engine recycling failed, reason: [" + reason + "]," +
+                " error: [" + error + "]");
+        return;
+    }
+    auto old = std::move(engine);
+    engine = std::move(fresh);
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        retired.emplace_back(std::move(old));
+        recycled_count += 1;
+        reasons[reason] += 1;
+    }
+    cv.notify_one();
+    wilton::support::log_info(logger, "Engine recycled, reason: [" + reason + "]," +
+            " millis since request: [" + sl::support::to_string(wait / 1000) + "]");
+}
+
+sl::json::value chakra_engine_recycler::stats() {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto reasons_list = std::vector<sl::json::field>();
+    for (auto& en : reasons) {
+        reasons_list.emplace_back(en.first, en.second);
+    }
+    auto built = recycled_count + failed_count;
+    return {
+        { "maxCalls", recycle_policy.max_calls },
+        { "maxMemoryGrowthBytes", recycle_policy.max_memory_growth_bytes },
+        { "maxAgeMillis", recycle_policy.max_age_millis },
+        { "scheduledCount", scheduled_count },
+        { "recycledCount", recycled_count },
+        { "failedCount", failed_count },
+        { "pendingBuilds", static_cast<uint32_t>(builds.size()) },
+        { "pendingDisposals", static_cast<uint32_t>(retired.size()) },
+        { "buildAvgMicros", built > 0 ? build_total_micros / built : 0 },
+        { "buildMaxMicros", build_max_micros },
+        { "reasons", std::move(reasons_list) }
+    };
+}
+
+void chakra_engine_recycler::run() {
+    std::unique_lock<std::mutex> guard{mutex};
+    while (!stopping) {
+        if (!retired.empty()) {
+            auto engine = std::move(retired.back());
+            retired.pop_back();
+            guard.unlock();
+            // runtime is disposed outside of the lock
+            engine.reset();
+            guard.lock();
+            continue;
+        }
+        if (!builds.empty()) {
+            auto rep = std::move(builds.front());
+            builds.pop_front();
+            guard.unlock();
+            auto start = std::chrono::steady_clock::now();
+            auto fresh = std::shared_ptr<chakra_engine>();
+            auto error = std::string();
+            try {
+                auto code = sl::io::span<const char>(init_code.data(), init_code.length());
+                fresh = std::make_shared<chakra_engine>(code);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            auto elapsed = micros_since(start);
+            {
+                std::lock_guard<std::mutex> rep_guard{rep->mutex};
+                rep->engine = std::move(fresh);
+                rep->error = std::move(error);
+                rep->done = true;
+            }
+            guard.lock();
+            build_total_micros += elapsed;
+            if (elapsed > build_max_micros) {
+                build_max_micros = elapsed;
+            }
+            continue;
+        }
+        cv.wait(guard);
+    }
+}
+
+} // namespace
+}
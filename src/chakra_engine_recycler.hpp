@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_engine_recycler.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 1:15 PM
+ */
+
+#ifndef WILTON_CHAKRA_ENGINE_RECYCLER_HPP
+#define WILTON_CHAKRA_ENGINE_RECYCLER_HPP
+
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_engine.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Replaces engines that reached the recycling limits, new engine is
+ * created on a background thread and swapped in by the engine owner
+ * only after it is ready; retired engines are destroyed on the same
+ * background thread
+ */
+class chakra_engine_recycler {
+public:
+    /**
+     * Replacement requested for a single engine
+     */
+    class replacement {
+        friend class chakra_engine_recycler;
+
+        std::mutex mutex;
+        std::shared_ptr<chakra_engine> engine;
+        bool done = false;
+        std::string error;
+
+    public:
+        const std::string reason;
+        const std::chrono::steady_clock::time_point requested;
+
+        replacement(const std::string& recycle_reason) :
+        reason(recycle_reason.data(), recycle_reason.length()),
+        requested(std::chrono::steady_clock::now()) { }
+
+        replacement(const replacement&) = delete;
+
+        replacement& operator=(const replacement&) = delete;
+    };
+
+private:
+    chakra_recycle_policy recycle_policy;
+    std::string init_code;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<replacement>> builds;
+    std::vector<std::shared_ptr<chakra_engine>> retired;
+    bool stopping = false;
+    std::thread worker;
+
+    // metrics, guarded by mutex
+    uint64_t scheduled_count = 0;
+    uint64_t recycled_count = 0;
+    uint64_t failed_count = 0;
+    std::map<std::string, uint64_t> reasons;
+    uint64_t build_total_micros = 0;
+    uint64_t build_max_micros = 0;
+
+public:
+    /**
+     * Starts background thread
+     *
+     * @param policy recycling limits
+     * @param init_code engine init script
+     */
+    chakra_engine_recycler(const chakra_recycle_policy& policy, std::string&& init_code);
+
+    ~chakra_engine_recycler() STATICLIB_NOEXCEPT;
+
+    chakra_engine_recycler(const chakra_engine_recycler&) = delete;
+
+    chakra_engine_recycler& operator=(const chakra_engine_recycler&) = delete;
+
+    /**
+     * Checks engine against the policy and requests a replacement if
+     * any limit is reached, must be called by the engine owner thread
+     * with no calls running on this engine
+     *
+     * @param engine engine to check
+     * @return requested replacement or empty pointer
+     */
+    std::shared_ptr<replacement> check(chakra_engine& engine);
+
+    /**
+     * Swaps engine with its replacement if the replacement is ready,
+     * pending pointer is reset when replacement is either used or failed;
+     * replaced engine is destroyed in background
+     *
+     * @param pending requested replacement
+     * @param engine engine to replace
+     */
+    void swap_if_ready(std::shared_ptr<replacement>& pending, std::shared_ptr<chakra_engine>& engine);
+
+    sl::json::value stats();
+
+private:
+    void run();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_ENGINE_RECYCLER_HPP */
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_gc_scheduler.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 9:15 PM
+ */
+
+#include "chakra_gc_scheduler.hpp"
+
+#include <chrono>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.gc");
+
+} // namespace
+
+chakra_gc_scheduler::chakra_gc_scheduler(uint32_t interval, std::function<void()> maintenance_task) :
+interval_millis(interval),
+task(std::move(maintenance_task)) {
+    wilton::support::log_info(logger, "Starting GC scheduler, interval millis: [" +
+            sl::support::to_string(interval_millis) + "]");
+    // started last, all fields are initialized
+    this->worker = std::thread([this] {
+        this->run();
+    });
+}
+
+chakra_gc_scheduler::~chakra_gc_scheduler() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+void chakra_gc_scheduler::run() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            auto stopped = cv.wait_for(guard, std::chrono::milliseconds(interval_millis), [this] {
+                return this->stopping;
+            });
+            if (stopped) {
+                return;
+            }
+        }
+        try {
+            task();
+        } catch (const std::exception& e) {
+            wilton::support::log_error(logger, TRACEMSG(e.what() + "\nGC maintenance error"));
+        } catch (...) {
+            wilton::support::log_error(logger, TRACEMSG("GC maintenance error"));
+        }
+    }
+}
+
+} // namespace
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_gc_scheduler.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 9:10 PM
+ */
+
+#ifndef WILTON_CHAKRA_GC_SCHEDULER_HPP
+#define WILTON_CHAKRA_GC_SCHEDULER_HPP
+
+#include <cstdint>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Background thread that periodically runs engine maintenance
+ * (idle-time garbage collection), task errors are logged
+ */
+class chakra_gc_scheduler {
+    uint32_t interval_millis;
+    std::function<void()> task;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread worker;
+
+public:
+    /**
+     * Starts the maintenance thread
+     *
+     * @param interval_millis delay between task runs
+     * @param task maintenance task
+     */
+    chakra_gc_scheduler(uint32_t interval_millis, std::function<void()> task);
+
+    ~chakra_gc_scheduler() STATICLIB_NOEXCEPT;
+
+    chakra_gc_scheduler(const chakra_gc_scheduler&) = delete;
+
+    chakra_gc_scheduler& operator=(const chakra_gc_scheduler&) = delete;
+
+private:
+    void run();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_GC_SCHEDULER_HPP */
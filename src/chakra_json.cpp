@@ -0,0 +1,313 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_json.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 5:25 PM
+ */
+
+#include "chakra_json.hpp"
+
+#include <cmath>
+#include <array>
+#include <vector>
+
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+// guards against cyclic values
+const size_t max_depth = 128;
+
+// ids beyond this count are not cached
+const size_t max_cached_prop_ids = 4096;
+
+// largest integer that is exactly representable as double
+const double max_safe_integer = 9007199254740991.0;
+
+void check(JsErrorCode err, const std::string& func) {
+    if (JsNoError != err) throw support::exception(TRACEMSG(
+            "'" + func + "' error, code: [" + sl::support::to_string(err) + "]"));
+}
+
+JsValueType value_type(JsValueRef val) {
+    JsValueType vt = JsUndefined;
+    check(JsGetValueType(val, std::addressof(vt)), "JsGetValueType");
+    return vt;
+}
+
+bool is_primitive(JsValueType vt) {
+    switch (vt) {
+    case JsUndefined:
+    case JsNull:
+    case JsNumber:
+    case JsString:
+    case JsBoolean:
+    case JsFunction:
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    case JsSymbol:
+#endif // WILTON_CHAKRA_CHAKRACORE
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool is_skipped_in_object(JsValueType vt) {
+    switch (vt) {
+    case JsUndefined:
+    case JsFunction:
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    case JsSymbol:
+#endif // WILTON_CHAKRA_CHAKRACORE
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+JsValueRef chakra_json::to_js(const sl::json::value& json) {
+    JsValueRef res = JS_INVALID_REFERENCE;
+    switch (json.json_type()) {
+    case sl::json::type::nullt:
+        check(JsGetNullValue(std::addressof(res)), "JsGetNullValue");
+        break;
+    case sl::json::type::object: {
+        check(JsCreateObject(std::addressof(res)), "JsCreateObject");
+        for (const sl::json::field& fi : json.as_object()) {
+            auto val = to_js(fi.val());
+            check(JsSetProperty(res, property_id(fi.name()), val, true), "JsSetProperty");
+        }
+        break;
+    }
+    case sl::json::type::array: {
+        auto& vec = json.as_array();
+        check(JsCreateArray(static_cast<unsigned int>(vec.size()), std::addressof(res)), "JsCreateArray");
+        for (size_t i = 0; i < vec.size(); i++) {
+            auto val = to_js(vec[i]);
+            JsValueRef idx = JS_INVALID_REFERENCE;
+            check(JsIntToNumber(static_cast<int>(i), std::addressof(idx)), "JsIntToNumber");
+            check(JsSetIndexedProperty(res, idx, val), "JsSetIndexedProperty");
+        }
+        break;
+    }
+    case sl::json::type::string: {
+        auto& str = json.as_string();
+        check(create_string({str.data(), str.length()}, wbuf, std::addressof(res)), "JsCreateString");
+        break;
+    }
+    case sl::json::type::integer:
+        check(JsDoubleToNumber(static_cast<double>(json.as_int64()), std::addressof(res)), "JsDoubleToNumber");
+        break;
+    case sl::json::type::real:
+        check(JsDoubleToNumber(json.as_double(), std::addressof(res)), "JsDoubleToNumber");
+        break;
+    case sl::json::type::boolean:
+        check(JsBoolToBoolean(json.as_bool(), std::addressof(res)), "JsBoolToBoolean");
+        break;
+    default:
+        throw support::exception(TRACEMSG("Unsupported JSON value: [" + json.dumps() + "]"));
+    }
+    return res;
+}
+
+sl::json::value chakra_json::from_js(JsValueRef val) {
+    return from_js(val, 0);
+}
+
+void chakra_json::release() STATICLIB_NOEXCEPT {
+    for (auto& en : prop_ids) {
+        JsRelease(en.second, nullptr);
+    }
+    prop_ids.clear();
+    // both are also present in the cache
+    length_prop = JS_INVALID_REFERENCE;
+    to_json_prop = JS_INVALID_REFERENCE;
+    if (JS_INVALID_REFERENCE != keys_fun) {
+        JsRelease(keys_fun, nullptr);
+    }
+    keys_fun = JS_INVALID_REFERENCE;
+    keys_ctx = JS_INVALID_REFERENCE;
+}
+
+sl::json::value chakra_json::from_js(JsValueRef val, size_t depth) {
+    JsValueType vt = JsUndefined;
+    auto resolved = resolve_to_json(val, vt);
+    return resolved_from_js(resolved, vt, depth);
+}
+
+sl::json::value chakra_json::resolved_from_js(JsValueRef val, JsValueType vt, size_t depth) {
+    if (depth > max_depth) throw support::exception(TRACEMSG(
+            "Value nesting is too deep, max depth: [" + sl::support::to_string(max_depth) + "]"));
+    switch (vt) {
+    case JsUndefined:
+    case JsNull:
+    case JsFunction:
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    case JsSymbol:
+#endif // WILTON_CHAKRA_CHAKRACORE
+        return sl::json::value();
+    case JsNumber: {
+        double num = 0;
+        check(JsNumberToDouble(val, std::addressof(num)), "JsNumberToDouble");
+        if (!std::isfinite(num)) {
+            return sl::json::value();
+        }
+        if (num == std::floor(num) && std::abs(num) <= max_safe_integer) {
+            return sl::json::value(static_cast<int64_t>(num));
+        }
+        return sl::json::value(num);
+    }
+    case JsString: {
+        auto str = std::string();
+        check(copy_string(val, str), "JsCopyString");
+        return sl::json::value(std::move(str));
+    }
+    case JsBoolean: {
+        bool flag = false;
+        check(JsBooleanToBool(val, std::addressof(flag)), "JsBooleanToBool");
+        return sl::json::value(flag);
+    }
+    case JsArray:
+        return array_from_js(val, depth);
+    default:
+        return object_from_js(val, depth);
+    }
+}
+
+// 'toJSON' is called once, its result is not checked for 'toJSON' again
+JsValueRef chakra_json::resolve_to_json(JsValueRef val, JsValueType& vt) {
+    vt = value_type(val);
+    if (is_primitive(vt)) {
+        return val;
+    }
+    if (JS_INVALID_REFERENCE == to_json_prop) {
+        to_json_prop = property_id("toJSON", true);
+    }
+    JsValueRef to_json = JS_INVALID_REFERENCE;
+    check(JsGetProperty(val, to_json_prop, std::addressof(to_json)), "JsGetProperty");
+    if (JsFunction != value_type(to_json)) {
+        return val;
+    }
+    // Date and user-defined serialization
+    JsValueRef replaced = JS_INVALID_REFERENCE;
+    check(JsCallFunction(to_json, std::addressof(val), 1, std::addressof(replaced)), "JsCallFunction");
+    vt = value_type(replaced);
+    return replaced;
+}
+
+sl::json::value chakra_json::object_from_js(JsValueRef val, size_t depth) {
+    auto names = own_keys(val);
+    auto len = array_length(names);
+    auto fields = std::vector<sl::json::field>();
+    fields.reserve(len);
+    auto name = std::string();
+    for (uint32_t i = 0; i < len; i++) {
+        JsValueRef idx = JS_INVALID_REFERENCE;
+        check(JsIntToNumber(static_cast<int>(i), std::addressof(idx)), "JsIntToNumber");
+        JsValueRef name_ref = JS_INVALID_REFERENCE;
+        check(JsGetIndexedProperty(names, idx, std::addressof(name_ref)), "JsGetIndexedProperty");
+        check(copy_string(name_ref, name), "JsCopyString");
+        JsValueRef field_ref = JS_INVALID_REFERENCE;
+        check(JsGetProperty(val, property_id(name), std::addressof(field_ref)), "JsGetProperty");
+        JsValueType vt = JsUndefined;
+        auto resolved = resolve_to_json(field_ref, vt);
+        if (is_skipped_in_object(vt)) {
+            continue;
+        }
+        fields.emplace_back(name, resolved_from_js(resolved, vt, depth + 1));
+    }
+    return sl::json::value(std::move(fields));
+}
+
+sl::json::value chakra_json::array_from_js(JsValueRef val, size_t depth) {
+    auto len = array_length(val);
+    auto vec = std::vector<sl::json::value>();
+    vec.reserve(len);
+    for (uint32_t i = 0; i < len; i++) {
+        JsValueRef idx = JS_INVALID_REFERENCE;
+        check(JsIntToNumber(static_cast<int>(i), std::addressof(idx)), "JsIntToNumber");
+        JsValueRef el = JS_INVALID_REFERENCE;
+        check(JsGetIndexedProperty(val, idx, std::addressof(el)), "JsGetIndexedProperty");
+        vec.emplace_back(from_js(el, depth + 1));
+    }
+    return sl::json::value(std::move(vec));
+}
+
+// unlike 'JsGetOwnPropertyNames', returns enumerable names only,
+// function is resolved again when called in other context
+JsValueRef chakra_json::own_keys(JsValueRef obj) {
+    JsContextRef ctx = JS_INVALID_REFERENCE;
+    check(JsGetCurrentContext(std::addressof(ctx)), "JsGetCurrentContext");
+    if (ctx != keys_ctx) {
+        JsValueRef global = JS_INVALID_REFERENCE;
+        check(JsGetGlobalObject(std::addressof(global)), "JsGetGlobalObject");
+        JsValueRef object_ctor = JS_INVALID_REFERENCE;
+        check(JsGetProperty(global, property_id("Object", true), std::addressof(object_ctor)), "JsGetProperty");
+        JsValueRef fun = JS_INVALID_REFERENCE;
+        check(JsGetProperty(object_ctor, property_id("keys", true), std::addressof(fun)), "JsGetProperty");
+        if (JsFunction != value_type(fun)) throw support::exception(TRACEMSG(
+                "Invalid 'Object.keys' function"));
+        check(JsAddRef(fun, nullptr), "JsAddRef");
+        if (JS_INVALID_REFERENCE != keys_fun) {
+            JsRelease(keys_fun, nullptr);
+        }
+        keys_fun = fun;
+        keys_ctx = ctx;
+    }
+    auto args = std::array<JsValueRef, 2>();
+    check(JsGetUndefinedValue(std::addressof(args[0])), "JsGetUndefinedValue");
+    args[1] = obj;
+    JsValueRef res = JS_INVALID_REFERENCE;
+    check(JsCallFunction(keys_fun, args.data(), static_cast<unsigned short>(args.size()),
+            std::addressof(res)), "JsCallFunction");
+    return res;
+}
+
+uint32_t chakra_json::array_length(JsValueRef arr) {
+    if (JS_INVALID_REFERENCE == length_prop) {
+        length_prop = property_id("length", true);
+    }
+    JsValueRef len_ref = JS_INVALID_REFERENCE;
+    check(JsGetProperty(arr, length_prop, std::addressof(len_ref)), "JsGetProperty");
+    double len = 0;
+    check(JsNumberToDouble(len_ref, std::addressof(len)), "JsNumberToDouble");
+    return static_cast<uint32_t>(len);
+}
+
+JsPropertyIdRef chakra_json::property_id(const std::string& name, bool pinned) {
+    auto it = prop_ids.find(name);
+    if (prop_ids.end() != it) {
+        return it->second;
+    }
+    JsPropertyIdRef res = JS_INVALID_REFERENCE;
+    check(create_property_id(name, std::addressof(res)), "JsCreatePropertyId");
+    if (pinned || prop_ids.size() < max_cached_prop_ids) {
+        check(JsAddRef(res, nullptr), "JsAddRef");
+        prop_ids.insert(std::make_pair(name, res));
+    }
+    return res;
+}
+
+} // namespace
+}
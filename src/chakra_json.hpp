@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_json.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 5:10 PM
+ */
+
+#ifndef WILTON_CHAKRA_JSON_HPP
+#define WILTON_CHAKRA_JSON_HPP
+
+#include <string>
+#include <unordered_map>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_jsrt.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Converts between native JSON values and JS values without
+ * intermediate JSON strings, property ids are cached per runtime;
+ * must be used with a context of the owning runtime set as current
+ */
+class chakra_json {
+    std::unordered_map<std::string, JsPropertyIdRef> prop_ids;
+    JsPropertyIdRef length_prop = JS_INVALID_REFERENCE;
+    JsPropertyIdRef to_json_prop = JS_INVALID_REFERENCE;
+    // 'Object.keys' of the context it was resolved in
+    JsContextRef keys_ctx = JS_INVALID_REFERENCE;
+    JsValueRef keys_fun = JS_INVALID_REFERENCE;
+    std::wstring wbuf;
+
+public:
+    chakra_json() { }
+
+    chakra_json(const chakra_json&) = delete;
+
+    chakra_json& operator=(const chakra_json&) = delete;
+
+    /**
+     * Creates JS value from the native one
+     *
+     * @param json native value
+     * @return JS value
+     */
+    JsValueRef to_js(const sl::json::value& json);
+
+    /**
+     * Reads JS value following 'JSON.stringify' rules: only own enumerable
+     * properties are read, 'toJSON' is respected, object fields with
+     * function or undefined values (also returned from 'toJSON') are skipped
+     *
+     * @param val JS value
+     * @return native value
+     */
+    sl::json::value from_js(JsValueRef val);
+
+    /**
+     * Releases cached property ids and functions, must be called before runtime disposal
+     */
+    void release() STATICLIB_NOEXCEPT;
+
+private:
+    sl::json::value from_js(JsValueRef val, size_t depth);
+
+    sl::json::value resolved_from_js(JsValueRef val, JsValueType vt, size_t depth);
+
+    JsValueRef resolve_to_json(JsValueRef val, JsValueType& vt);
+
+    sl::json::value object_from_js(JsValueRef val, size_t depth);
+
+    JsValueRef own_keys(JsValueRef obj);
+
+    sl::json::value array_from_js(JsValueRef val, size_t depth);
+
+    uint32_t array_length(JsValueRef arr);
+
+    JsPropertyIdRef property_id(const std::string& name, bool pinned = false);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_JSON_HPP */
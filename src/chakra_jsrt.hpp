@@ -0,0 +1,193 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_jsrt.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 1:10 PM
+ */
+
+#ifndef WILTON_CHAKRA_JSRT_HPP
+#define WILTON_CHAKRA_JSRT_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef WILTON_CHAKRA_CHAKRACORE
+#include <ChakraCore.h>
+#ifndef CALLBACK
+#define CALLBACK CHAKRA_CALLBACK
+#endif // CALLBACK
+#else // !WILTON_CHAKRA_CHAKRACORE
+#include <jsrt.h>
+#endif // WILTON_CHAKRA_CHAKRACORE
+
+#include "staticlib/io.hpp"
+#include "staticlib/utils.hpp"
+
+namespace wilton {
+namespace chakra {
+
+// Functions below hide the differences between the Windows jsrt (UTF-16 only)
+// and ChakraCore (UTF-8) string APIs, ChakraCore variants do a single copy
+// between the caller buffer and the engine heap
+
+inline JsErrorCode create_runtime(JsRuntimeAttributes attrs, JsRuntimeHandle* runtime) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    return JsCreateRuntime(attrs, nullptr, runtime);
+#else // !WILTON_CHAKRA_CHAKRACORE
+    return JsCreateRuntime(attrs, JsRuntimeVersion11, nullptr, runtime);
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+inline JsErrorCode create_context(JsRuntimeHandle runtime, JsContextRef* ctx) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    return JsCreateContext(runtime, ctx);
+#else // !WILTON_CHAKRA_CHAKRACORE
+    return JsCreateContext(runtime, nullptr, ctx);
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+#ifndef WILTON_CHAKRA_CHAKRACORE
+inline void widen_into(sl::io::span<const char> str, std::wstring& out) {
+    out.clear();
+    if (0 == str.size()) return;
+    auto len = ::MultiByteToWideChar(CP_UTF8, 0, str.data(), static_cast<int>(str.size()), nullptr, 0);
+    out.resize(static_cast<size_t>(len));
+    ::MultiByteToWideChar(CP_UTF8, 0, str.data(), static_cast<int>(str.size()),
+            std::addressof(out.front()), len);
+}
+#endif // !WILTON_CHAKRA_CHAKRACORE
+
+/**
+ * Creates JS string from UTF-8 data
+ *
+ * @param str UTF-8 string
+ * @param wbuf reusable conversion buffer, not used with ChakraCore
+ * @param res JS string
+ * @return error code
+ */
+inline JsErrorCode create_string(sl::io::span<const char> str, std::wstring& wbuf, JsValueRef* res) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    (void) wbuf;
+    return JsCreateString(str.data(), str.size(), res);
+#else // !WILTON_CHAKRA_CHAKRACORE
+    widen_into(str, wbuf);
+    return JsPointerToString(wbuf.c_str(), wbuf.length(), res);
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+inline JsErrorCode create_string(sl::io::span<const char> str, JsValueRef* res) {
+    auto wbuf = std::wstring();
+    return create_string(str, wbuf, res);
+}
+
+/**
+ * Copies JS string contents as UTF-8, previous contents
+ * of the output buffer are discarded, its capacity is reused
+ *
+ * @param str JS string
+ * @param out output buffer
+ * @return error code
+ */
+inline JsErrorCode copy_string(JsValueRef str, std::string& out) {
+    out.clear();
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    size_t len = 0;
+    auto err_len = JsCopyString(str, nullptr, 0, std::addressof(len));
+    if (JsNoError != err_len) return err_len;
+    if (0 == len) return JsNoError;
+    out.resize(len);
+    size_t written = 0;
+    return JsCopyString(str, std::addressof(out.front()), len, std::addressof(written));
+#else // !WILTON_CHAKRA_CHAKRACORE
+    size_t wlen = 0;
+    const wchar_t* wptr = nullptr;
+    auto err_ptr = JsStringToPointer(str, std::addressof(wptr), std::addressof(wlen));
+    if (JsNoError != err_ptr) return err_ptr;
+    if (0 == wlen) return JsNoError;
+    auto len = ::WideCharToMultiByte(CP_UTF8, 0, wptr, static_cast<int>(wlen), nullptr, 0, nullptr, nullptr);
+    out.resize(static_cast<size_t>(len));
+    ::WideCharToMultiByte(CP_UTF8, 0, wptr, static_cast<int>(wlen), std::addressof(out.front()), len,
+            nullptr, nullptr);
+    return JsNoError;
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+inline JsErrorCode create_property_id(const std::string& name, JsPropertyIdRef* res) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    return JsCreatePropertyId(name.c_str(), name.length(), res);
+#else // !WILTON_CHAKRA_CHAKRACORE
+    auto wname = sl::utils::widen(name);
+    return JsGetPropertyIdFromName(wname.c_str(), res);
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+/**
+ * Pool of reusable string buffers, buffers are taken for the duration
+ * of a single boundary crossing, so nested calls (JS -> native -> JS)
+ * on the same engine do not overwrite each other
+ */
+class string_buffer_pool {
+    std::vector<std::string> free_list;
+
+public:
+    std::string take() {
+        if (free_list.empty()) {
+            return std::string();
+        }
+        auto res = std::move(free_list.back());
+        free_list.pop_back();
+        return res;
+    }
+
+    void give_back(std::string&& buf) {
+        // do not retain unusually large buffers
+        if (free_list.size() < 4 && buf.capacity() <= (1 << 24)) {
+            buf.clear();
+            free_list.emplace_back(std::move(buf));
+        }
+    }
+};
+
+/**
+ * Buffer taken from the pool, returned back on destruction
+ */
+class pooled_string {
+    string_buffer_pool& pool;
+
+public:
+    std::string value;
+
+    pooled_string(string_buffer_pool& buffer_pool) :
+    pool(buffer_pool),
+    value(buffer_pool.take()) { }
+
+    ~pooled_string() STATICLIB_NOEXCEPT {
+        pool.give_back(std::move(value));
+    }
+
+    pooled_string(const pooled_string&) = delete;
+
+    pooled_string& operator=(const pooled_string&) = delete;
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_JSRT_HPP */
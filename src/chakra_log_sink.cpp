@@ -0,0 +1,277 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_log_sink.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 5:20 PM
+ */
+
+#include "chakra_log_sink.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.logsink");
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex sink_mutex;
+std::shared_ptr<chakra_log_sink> sink_instance;
+
+size_t round_up_pow2(uint32_t val) {
+    size_t res = 1;
+    while (res < val) {
+        res <<= 1;
+    }
+    return res;
+}
+
+} // namespace
+
+chakra_log_ring::chakra_log_ring(uint32_t capacity) :
+mask(round_up_pow2(capacity) - 1),
+head(0),
+tail(0),
+closed(false),
+dropped(0) {
+    slots.resize(mask + 1);
+}
+
+bool chakra_log_ring::try_push(chakra_log_record&& rec) {
+    auto t = tail.load(std::memory_order_relaxed);
+    auto h = head.load(std::memory_order_acquire);
+    if (t - h >= slots.size()) {
+        return false;
+    }
+    slots[t & mask] = std::move(rec);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+size_t chakra_log_ring::drain(std::vector<chakra_log_record>& out) {
+    auto h = head.load(std::memory_order_relaxed);
+    auto t = tail.load(std::memory_order_acquire);
+    for (auto i = h; i != t; i++) {
+        out.emplace_back(std::move(slots[i & mask]));
+    }
+    head.store(t, std::memory_order_release);
+    return t - h;
+}
+
+size_t chakra_log_ring::size() const {
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+chakra_log_sink::chakra_log_sink(uint32_t capacity, bool block, uint32_t flush_interval) :
+ring_capacity(capacity),
+block_when_full(block),
+flush_interval_millis(flush_interval),
+written_count(0),
+dropped_count(0),
+blocked_count(0) {
+    wilton::support::log_info(logger, std::string() + "Starting log writer thread," +
+            " ring capacity: [" + sl::support::to_string(capacity) + "]," +
+            " block when full: [" + sl::support::to_string_bool(block) + "]," +
+            " flush interval millis: [" + sl::support::to_string(flush_interval) + "]");
+    this->worker = std::thread([this] {
+        this->run();
+    });
+}
+
+chakra_log_sink::~chakra_log_sink() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    drained_cv.notify_all();
+    worker.join();
+}
+
+std::shared_ptr<chakra_log_ring> chakra_log_sink::open_ring() {
+    auto ring = std::make_shared<chakra_log_ring>(ring_capacity);
+    std::lock_guard<std::mutex> guard{mutex};
+    rings.push_back(ring);
+    return ring;
+}
+
+void chakra_log_sink::close_ring(std::shared_ptr<chakra_log_ring> ring) STATICLIB_NOEXCEPT {
+    ring->closed.store(true, std::memory_order_release);
+    cv.notify_one();
+}
+
+void chakra_log_sink::push(chakra_log_ring& ring, chakra_log_record&& rec) {
+    if (ring.try_push(std::move(rec))) {
+        // writer is woken up early only when the ring is filling up,
+        // notification without the lock may be missed, writer wakes up on timer anyway
+        if (ring.size() == ring.capacity() / 2) {
+            cv.notify_one();
+        }
+        return;
+    }
+    if (block_when_full) {
+        blocked_count.fetch_add(1, std::memory_order_relaxed);
+        // ring is re-checked under the lock, writer takes the lock
+        // after draining before notifying, so wake-up cannot be missed
+        std::unique_lock<std::mutex> guard{mutex};
+        while (!stopping) {
+            if (ring.try_push(std::move(rec))) {
+                return;
+            }
+            cv.notify_one();
+            drained_cv.wait(guard);
+        }
+    }
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    dropped_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+sl::json::value chakra_log_sink::stats() {
+    uint32_t count = 0;
+    uint64_t pending = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        count = static_cast<uint32_t>(rings.size());
+        for (auto& ring : rings) {
+            pending += ring->size();
+        }
+    }
+    return {
+        { "ringCapacity", ring_capacity },
+        { "blockWhenFull", block_when_full },
+        { "rings", count },
+        { "pendingRecords", pending },
+        { "writtenRecords", written_count.load(std::memory_order_relaxed) },
+        { "droppedRecords", dropped_count.load(std::memory_order_relaxed) },
+        { "blockedPushes", blocked_count.load(std::memory_order_relaxed) }
+    };
+}
+
+void chakra_log_sink::run() {
+    auto batch = std::vector<chakra_log_record>();
+    auto print_buf = std::string();
+    auto list = std::vector<std::shared_ptr<chakra_log_ring>>();
+    auto done = false;
+    while (!done) {
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            if (!stopping) {
+                cv.wait_for(guard, std::chrono::milliseconds(flush_interval_millis));
+            }
+            // rings are drained once more after stop is requested
+            done = stopping;
+            // closed rings are removed only after they are drained below,
+            // engine does not push after closing
+            list = rings;
+            rings.erase(std::remove_if(rings.begin(), rings.end(),
+                    [](const std::shared_ptr<chakra_log_ring>& ring) {
+                        return ring->closed.load(std::memory_order_acquire);
+                    }), rings.end());
+        }
+        for (auto& ring : list) {
+            ring->drain(batch);
+            // producers blocked on a full ring are woken before the slow write,
+            // lock is taken so a producer cannot miss this between its check and wait
+            {
+                std::lock_guard<std::mutex> guard{mutex};
+            }
+            drained_cv.notify_all();
+            auto dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+            write(batch, print_buf);
+            if (dropped > 0) {
+                wilton::support::log_warn(logger, "Ring buffer is full, records dropped: [" +
+                        sl::support::to_string(dropped) + "]");
+            }
+        }
+        list.clear();
+    }
+}
+
+void chakra_log_sink::write(std::vector<chakra_log_record>& batch, std::string& print_buf) {
+    // consecutive print records are written with a single call,
+    // pending output is flushed before log records to keep the order
+    auto flush_print = [&print_buf] {
+        if (!print_buf.empty()) {
+            std::fwrite(print_buf.data(), 1, print_buf.length(), stdout);
+            std::fflush(stdout);
+            print_buf.clear();
+        }
+    };
+    for (auto& rec : batch) {
+        switch (rec.kind) {
+        case chakra_log_kind::print:
+            print_buf += rec.message;
+            print_buf.push_back('\n');
+            break;
+        case chakra_log_kind::debug:
+            flush_print();
+            wilton::support::log_debug(rec.logger, rec.message);
+            break;
+        case chakra_log_kind::info:
+            flush_print();
+            wilton::support::log_info(rec.logger, rec.message);
+            break;
+        case chakra_log_kind::warn:
+            flush_print();
+            wilton::support::log_warn(rec.logger, rec.message);
+            break;
+        case chakra_log_kind::error:
+            flush_print();
+            wilton::support::log_error(rec.logger, rec.message);
+            break;
+        }
+    }
+    flush_print();
+    written_count.fetch_add(batch.size(), std::memory_order_relaxed);
+    batch.clear();
+}
+
+std::shared_ptr<chakra_log_sink> shared_log_sink(uint32_t ring_capacity, bool block_when_full,
+        uint32_t flush_interval_millis) {
+    std::lock_guard<std::mutex> guard{sink_mutex};
+    if (nullptr == sink_instance.get()) {
+        sink_instance = std::make_shared<chakra_log_sink>(ring_capacity, block_when_full, flush_interval_millis);
+    }
+    return sink_instance;
+}
+
+sl::json::value log_sink_stats() {
+    auto sink = std::shared_ptr<chakra_log_sink>();
+    {
+        std::lock_guard<std::mutex> guard{sink_mutex};
+        sink = sink_instance;
+    }
+    if (nullptr == sink.get()) {
+        return sl::json::value();
+    }
+    return sink->stats();
+}
+
+} // namespace
+}
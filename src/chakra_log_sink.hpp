@@ -0,0 +1,188 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_log_sink.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 5:00 PM
+ */
+
+#ifndef WILTON_CHAKRA_LOG_SINK_HPP
+#define WILTON_CHAKRA_LOG_SINK_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+enum class chakra_log_kind {
+    print, debug, info, warn, error
+};
+
+/**
+ * Print output or log message, formatted only by the writer thread
+ */
+struct chakra_log_record {
+    chakra_log_kind kind = chakra_log_kind::print;
+    std::string logger;
+    std::string message;
+};
+
+/**
+ * Single-producer single-consumer ring of records, producer is the
+ * thread that currently runs the engine, consumer is the writer thread
+ */
+class chakra_log_ring {
+    std::vector<chakra_log_record> slots;
+    size_t mask;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+
+public:
+    // set by the engine on dispose, ring is removed after it is drained
+    std::atomic<bool> closed;
+    // not yet reported by the writer
+    std::atomic<uint64_t> dropped;
+
+    /**
+     * Constructor
+     *
+     * @param capacity min number of records, rounded up to a power of two
+     */
+    chakra_log_ring(uint32_t capacity);
+
+    chakra_log_ring(const chakra_log_ring&) = delete;
+
+    chakra_log_ring& operator=(const chakra_log_ring&) = delete;
+
+    /**
+     * Adds record if there is space, record is moved only on success
+     *
+     * @param rec record
+     * @return false if ring is full
+     */
+    bool try_push(chakra_log_record&& rec);
+
+    /**
+     * Moves records into the output in the order they were pushed
+     *
+     * @param out output list
+     * @return number of records taken
+     */
+    size_t drain(std::vector<chakra_log_record>& out);
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    size_t size() const;
+};
+
+/**
+ * Process-wide writer, drains rings of all engines on a single
+ * background thread, print output is written to stdout in batches,
+ * log messages are passed to the wilton logger
+ */
+class chakra_log_sink {
+    const uint32_t ring_capacity;
+    const bool block_when_full;
+    const uint32_t flush_interval_millis;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    // signalled by the writer after each drain, producers blocked on a full ring wait on it
+    std::condition_variable drained_cv;
+    std::vector<std::shared_ptr<chakra_log_ring>> rings;
+    bool stopping = false;
+    std::thread worker;
+
+    std::atomic<uint64_t> written_count;
+    std::atomic<uint64_t> dropped_count;
+    std::atomic<uint64_t> blocked_count;
+
+public:
+    /**
+     * Starts writer thread
+     *
+     * @param ring_capacity records per engine
+     * @param block_when_full block producer instead of dropping records
+     * @param flush_interval_millis max delay before the records are written
+     */
+    chakra_log_sink(uint32_t ring_capacity, bool block_when_full, uint32_t flush_interval_millis);
+
+    ~chakra_log_sink() STATICLIB_NOEXCEPT;
+
+    chakra_log_sink(const chakra_log_sink&) = delete;
+
+    chakra_log_sink& operator=(const chakra_log_sink&) = delete;
+
+    std::shared_ptr<chakra_log_ring> open_ring();
+
+    /**
+     * Records already pushed are still written after this call
+     *
+     * @param ring engine ring
+     */
+    void close_ring(std::shared_ptr<chakra_log_ring> ring) STATICLIB_NOEXCEPT;
+
+    /**
+     * Pushes record applying configured back-pressure, must be
+     * called only by the thread that currently runs the engine;
+     * blocked producer drops the record if the writer is stopped
+     *
+     * @param ring engine ring
+     * @param rec record
+     */
+    void push(chakra_log_ring& ring, chakra_log_record&& rec);
+
+    sl::json::value stats();
+
+private:
+    void run();
+
+    void write(std::vector<chakra_log_record>& batch, std::string& print_buf);
+};
+
+/**
+ * Returns sink, it is created on the first call with the specified parameters
+ */
+std::shared_ptr<chakra_log_sink> shared_log_sink(uint32_t ring_capacity, bool block_when_full,
+        uint32_t flush_interval_millis);
+
+/**
+ * Returns stats or null if sink is not created
+ *
+ * @return JSON value
+ */
+sl::json::value log_sink_stats();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_LOG_SINK_HPP */
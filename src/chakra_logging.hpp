@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_logging.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 10:20 PM
+ */
+
+#ifndef WILTON_CHAKRA_LOGGING_HPP
+#define WILTON_CHAKRA_LOGGING_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "wilton/wilton.h"
+#include "wilton/wilton_logging.h"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Cached check whether debug level is enabled for the logger, message
+ * should be formatted only if this check passes; level is re-read
+ * periodically, so logging config changes are picked up with a delay;
+ * instance must not be shared between threads
+ */
+class debug_log_gate {
+    std::string logger;
+    uint32_t checks_left = 0;
+    bool enabled = false;
+
+public:
+    // number of checks served from cache
+    static const uint32_t recheck_interval = 1024;
+
+    debug_log_gate(const std::string& logger_name) :
+    logger(logger_name.data(), logger_name.length()) { }
+
+    const std::string& name() const {
+        return logger;
+    }
+
+    bool is_enabled() {
+        if (checks_left > 0) {
+            checks_left -= 1;
+            return enabled;
+        }
+        int res = 0;
+        auto err = wilton_logger_is_level_enabled(logger.c_str(), static_cast<int>(logger.length()),
+                "DEBUG", 5, std::addressof(res));
+        if (nullptr != err) {
+            wilton_free(err);
+            res = 0;
+        }
+        this->enabled = 0 != res;
+        this->checks_left = recheck_interval;
+        return enabled;
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_LOGGING_HPP */
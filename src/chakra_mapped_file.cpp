@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_mapped_file.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 11:42 AM
+ */
+
+#include "chakra_mapped_file.hpp"
+
+#include "staticlib/config.hpp"
+
+#ifdef STATICLIB_WINDOWS
+#ifndef UNICODE
+#define UNICODE
+#endif // UNICODE
+#ifndef _UNICODE
+#define _UNICODE
+#endif // _UNICODE
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <windows.h>
+#else // !STATICLIB_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif // STATICLIB_WINDOWS
+
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+namespace wilton {
+namespace chakra {
+
+#ifdef STATICLIB_WINDOWS
+
+chakra_mapped_file::chakra_mapped_file(const std::string& file_path, bool copy_on_write) :
+path(file_path.data(), file_path.length()) {
+    auto wpath = sl::utils::widen(path);
+    HANDLE fh = ::CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == fh) throw support::exception(TRACEMSG(
+            "Error opening file for mapping, path: [" + path + "]," +
+            " error: [" + sl::utils::errcode_to_string(::GetLastError()) + "]"));
+    this->file_handle = reinterpret_cast<intptr_t>(fh);
+    LARGE_INTEGER size;
+    auto err_size = ::GetFileSizeEx(fh, std::addressof(size));
+    if (0 == err_size) {
+        auto code = ::GetLastError();
+        ::CloseHandle(fh);
+        throw support::exception(TRACEMSG("Error getting file size, path: [" + path + "]," +
+                " error: [" + sl::utils::errcode_to_string(code) + "]"));
+    }
+    this->len = static_cast<size_t>(size.QuadPart);
+    if (0 == len) {
+        // empty files cannot be mapped
+        this->ptr = "";
+        return;
+    }
+    HANDLE mh = ::CreateFileMappingW(fh, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if (nullptr == mh) {
+        auto code = ::GetLastError();
+        ::CloseHandle(fh);
+        throw support::exception(TRACEMSG("Error creating file mapping, path: [" + path + "]," +
+                " error: [" + sl::utils::errcode_to_string(code) + "]"));
+    }
+    this->mapping_handle = reinterpret_cast<intptr_t>(mh);
+    auto view = ::MapViewOfFile(mh, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (nullptr == view) {
+        auto code = ::GetLastError();
+        ::CloseHandle(mh);
+        ::CloseHandle(fh);
+        throw support::exception(TRACEMSG("Error mapping file view, path: [" + path + "]," +
+                " error: [" + sl::utils::errcode_to_string(code) + "]"));
+    }
+    this->ptr = static_cast<const char*>(view);
+}
+
+chakra_mapped_file::~chakra_mapped_file() STATICLIB_NOEXCEPT {
+    if (-1 != mapping_handle) {
+        ::UnmapViewOfFile(ptr);
+        ::CloseHandle(reinterpret_cast<HANDLE>(mapping_handle));
+    }
+    if (-1 != file_handle) {
+        ::CloseHandle(reinterpret_cast<HANDLE>(file_handle));
+    }
+}
+
+chakra_file_stamp read_file_stamp(const std::string& path) {
+    auto res = chakra_file_stamp();
+    auto wpath = sl::utils::widen(path);
+    WIN32_FILE_ATTRIBUTE_DATA attrs;
+    auto err = ::GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, std::addressof(attrs));
+    if (0 == err) {
+        return res;
+    }
+    auto ft = attrs.ftLastWriteTime;
+    res.exists = true;
+    res.size = (static_cast<uint64_t>(attrs.nFileSizeHigh) << 32) | attrs.nFileSizeLow;
+    res.mtime = static_cast<int64_t>((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime);
+    return res;
+}
+
+#else // !STATICLIB_WINDOWS
+
+chakra_mapped_file::chakra_mapped_file(const std::string& file_path, bool copy_on_write) :
+path(file_path.data(), file_path.length()) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (-1 == fd) throw support::exception(TRACEMSG(
+            "Error opening file for mapping, path: [" + path + "]," +
+            " error: [" + ::strerror(errno) + "]"));
+    struct stat st;
+    auto err_stat = ::fstat(fd, std::addressof(st));
+    if (0 != err_stat) {
+        auto code = errno;
+        ::close(fd);
+        throw support::exception(TRACEMSG("Error getting file size, path: [" + path + "]," +
+                " error: [" + ::strerror(code) + "]"));
+    }
+    this->len = static_cast<size_t>(st.st_size);
+    if (0 == len) {
+        // empty files cannot be mapped
+        ::close(fd);
+        this->ptr = "";
+        return;
+    }
+    auto addr = copy_on_write ?
+            ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) :
+            ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    // close may overwrite errno
+    auto code = MAP_FAILED == addr ? errno : 0;
+    // mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (MAP_FAILED == addr) throw support::exception(TRACEMSG(
+            "Error mapping file, path: [" + path + "]," +
+            " error: [" + ::strerror(code) + "]"));
+    this->ptr = static_cast<const char*>(addr);
+    this->mapping_handle = 0;
+}
+
+chakra_mapped_file::~chakra_mapped_file() STATICLIB_NOEXCEPT {
+    if (-1 != mapping_handle) {
+        ::munmap(const_cast<char*>(ptr), len);
+    }
+}
+
+chakra_file_stamp read_file_stamp(const std::string& path) {
+    auto res = chakra_file_stamp();
+    struct stat st;
+    auto err = ::stat(path.c_str(), std::addressof(st));
+    if (0 != err) {
+        return res;
+    }
+#ifdef STATICLIB_MAC
+    auto& ts = st.st_mtimespec;
+#else // !STATICLIB_MAC
+    auto& ts = st.st_mtim;
+#endif // STATICLIB_MAC
+    res.exists = true;
+    res.size = static_cast<uint64_t>(st.st_size);
+    res.mtime = static_cast<int64_t>(ts.tv_sec) * 1000000000 + static_cast<int64_t>(ts.tv_nsec);
+    return res;
+}
+
+#endif // STATICLIB_WINDOWS
+
+} // namespace
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_mapped_file.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 11:40 AM
+ */
+
+#ifndef WILTON_CHAKRA_MAPPED_FILE_HPP
+#define WILTON_CHAKRA_MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "staticlib/io.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Memory mapping of a whole file, contents stay valid
+ * (and shared between all users) until the object is destroyed;
+ * mapping is read-only unless it is created as copy-on-write
+ */
+class chakra_mapped_file {
+    std::string path;
+    const char* ptr = nullptr;
+    size_t len = 0;
+    // HANDLE values on windows, fd on others
+    intptr_t file_handle = -1;
+    intptr_t mapping_handle = -1;
+
+public:
+    /**
+     * Maps the file
+     *
+     * @param file_path file path
+     * @param copy_on_write map pages as writable private copies, writes
+     *        do not fault and are never written back to the file
+     */
+    chakra_mapped_file(const std::string& file_path, bool copy_on_write = false);
+
+    ~chakra_mapped_file() STATICLIB_NOEXCEPT;
+
+    chakra_mapped_file(const chakra_mapped_file&) = delete;
+
+    chakra_mapped_file& operator=(const chakra_mapped_file&) = delete;
+
+    sl::io::span<const char> data() const {
+        return {ptr, len};
+    }
+
+    const std::string& file_path() const {
+        return path;
+    }
+};
+
+/**
+ * Size and last write time of a file on disk
+ */
+struct chakra_file_stamp {
+    bool exists = false;
+    uint64_t size = 0;
+    // nanoseconds on posix, 100-nanosecond intervals on windows
+    int64_t mtime = 0;
+
+    bool same_as(const chakra_file_stamp& other) const {
+        return exists == other.exists && size == other.size && mtime == other.mtime;
+    }
+};
+
+/**
+ * Reads size and last write time of the specified file
+ *
+ * @param path file path
+ * @return file stamp, "exists" flag is not set if file is not accessible
+ */
+chakra_file_stamp read_file_stamp(const std::string& path);
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_MAPPED_FILE_HPP */
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_memory.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 7:45 PM
+ */
+
+#include "chakra_memory.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+std::atomic<uint64_t> engine_counter(0);
+
+// engines are registered from different threads
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<chakra_memory_stats>> registry;
+
+void atomic_max(std::atomic<uint64_t>& target, uint64_t val) {
+    auto prev = target.load(std::memory_order_relaxed);
+    while (val > prev && !target.compare_exchange_weak(prev, val, std::memory_order_relaxed)) { }
+}
+
+bool CALLBACK memory_allocation_callback(void* callback_state, JsMemoryEventType event,
+        size_t size) STATICLIB_NOEXCEPT {
+    auto stats = static_cast<chakra_memory_stats*>(callback_state);
+    switch (event) {
+    case JsMemoryAllocate: {
+        stats->allocation_count.fetch_add(1, std::memory_order_relaxed);
+        auto current = stats->tracked_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        atomic_max(stats->peak_bytes, current);
+        break;
+    }
+    case JsMemoryFree:
+        stats->free_count.fetch_add(1, std::memory_order_relaxed);
+        stats->tracked_bytes.fetch_sub(size, std::memory_order_relaxed);
+        break;
+    case JsMemoryFailure:
+        stats->failed_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        break;
+    default:
+        break;
+    }
+    // allocations are never vetoed here, hard limit is enforced by the runtime
+    return true;
+}
+
+void CALLBACK before_collect_callback(void* callback_state) STATICLIB_NOEXCEPT {
+    auto stats = static_cast<chakra_memory_stats*>(callback_state);
+    stats->collection_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+chakra_memory_stats::chakra_memory_stats(JsRuntimeHandle runtime_handle, uint64_t memory_limit_bytes,
+        uint64_t soft_limit_bytes) :
+last_thread(std::this_thread::get_id()),
+engine_id(engine_counter.fetch_add(1) + 1),
+runtime(runtime_handle),
+memory_limit(memory_limit_bytes),
+soft_limit(soft_limit_bytes),
+tracked_bytes(0),
+peak_bytes(0),
+allocation_count(0),
+free_count(0),
+failed_allocation_count(0),
+soft_limit_collections(0),
+collection_count(0),
+timed_collection_count(0),
+timed_collection_total_micros(0),
+timed_collection_max_micros(0),
+idle_collections(0),
+idle_call_count(0),
+idle_call_total_micros(0),
+last_activity_millis(monotonic_millis()) { }
+
+void chakra_memory_stats::set_thread(std::thread::id tid) {
+    std::lock_guard<std::mutex> guard{thread_mutex};
+    last_thread = tid;
+}
+
+void chakra_memory_stats::record_collection(uint64_t micros) {
+    timed_collection_count.fetch_add(1, std::memory_order_relaxed);
+    timed_collection_total_micros.fetch_add(micros, std::memory_order_relaxed);
+    atomic_max(timed_collection_max_micros, micros);
+}
+
+void chakra_memory_stats::record_idle_call(uint64_t micros) {
+    idle_call_count.fetch_add(1, std::memory_order_relaxed);
+    idle_call_total_micros.fetch_add(micros, std::memory_order_relaxed);
+}
+
+sl::json::value chakra_memory_stats::to_json() {
+    auto tid = std::thread::id();
+    {
+        std::lock_guard<std::mutex> guard{thread_mutex};
+        tid = last_thread;
+    }
+    auto timed_count = timed_collection_count.load(std::memory_order_relaxed);
+    auto timed_total = timed_collection_total_micros.load(std::memory_order_relaxed);
+    auto idle_millis = monotonic_millis() - last_activity_millis.load(std::memory_order_relaxed);
+    size_t usage = 0;
+    // usage can be read while runtime is active on other thread
+    JsGetRuntimeMemoryUsage(runtime, std::addressof(usage));
+    return {
+        { "engineId", engine_id },
+        { "threadId", sl::support::to_string_any(tid) },
+        { "usageBytes", static_cast<uint64_t>(usage) },
+        { "trackedBytes", tracked_bytes.load(std::memory_order_relaxed) },
+        { "peakBytes", peak_bytes.load(std::memory_order_relaxed) },
+        { "allocationCount", allocation_count.load(std::memory_order_relaxed) },
+        { "freeCount", free_count.load(std::memory_order_relaxed) },
+        { "failedAllocationCount", failed_allocation_count.load(std::memory_order_relaxed) },
+        { "memoryLimit", memory_limit },
+        { "softLimit", soft_limit },
+        { "softLimitCollections", soft_limit_collections.load(std::memory_order_relaxed) },
+        { "collectionCount", collection_count.load(std::memory_order_relaxed) },
+        { "timedCollectionCount", timed_count },
+        { "timedCollectionAvgMicros", timed_count > 0 ? timed_total / timed_count : 0 },
+        { "timedCollectionMaxMicros", timed_collection_max_micros.load(std::memory_order_relaxed) },
+        { "idleCollections", idle_collections.load(std::memory_order_relaxed) },
+        { "idleCallCount", idle_call_count.load(std::memory_order_relaxed) },
+        { "idleCallTotalMicros", idle_call_total_micros.load(std::memory_order_relaxed) },
+        { "idleMillis", idle_millis }
+    };
+}
+
+uint64_t monotonic_millis() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+void register_memory_stats(std::shared_ptr<chakra_memory_stats> stats) {
+    auto err = JsSetRuntimeMemoryAllocationCallback(stats->runtime, stats.get(), memory_allocation_callback);
+    if (JsNoError != err) throw support::exception(TRACEMSG(
+            "'JsSetRuntimeMemoryAllocationCallback' error, code: [" + sl::support::to_string(err) + "]"));
+    auto err_gc = JsSetRuntimeBeforeCollectCallback(stats->runtime, stats.get(), before_collect_callback);
+    if (JsNoError != err_gc) throw support::exception(TRACEMSG(
+            "'JsSetRuntimeBeforeCollectCallback' error, code: [" + sl::support::to_string(err_gc) + "]"));
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    registry.emplace_back(std::move(stats));
+}
+
+void unregister_memory_stats(const std::shared_ptr<chakra_memory_stats>& stats) STATICLIB_NOEXCEPT {
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    for (auto it = registry.begin(); it != registry.end(); ++it) {
+        if (it->get() == stats.get()) {
+            registry.erase(it);
+            break;
+        }
+    }
+}
+
+sl::json::value memory_stats_snapshot() {
+    auto vec = std::vector<sl::json::value>();
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    for (auto& st : registry) {
+        vec.emplace_back(st->to_json());
+    }
+    return sl::json::value(std::move(vec));
+}
+
+} // namespace
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_memory.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 7:30 PM
+ */
+
+#ifndef WILTON_CHAKRA_MEMORY_HPP
+#define WILTON_CHAKRA_MEMORY_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_jsrt.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Memory counters of a single engine, allocation callback
+ * may be called from engine background threads
+ */
+class chakra_memory_stats {
+    std::mutex thread_mutex;
+    std::thread::id last_thread;
+
+public:
+    const uint64_t engine_id;
+    const JsRuntimeHandle runtime;
+    const uint64_t memory_limit;
+    const uint64_t soft_limit;
+
+    std::atomic<uint64_t> tracked_bytes;
+    std::atomic<uint64_t> peak_bytes;
+    std::atomic<uint64_t> allocation_count;
+    std::atomic<uint64_t> free_count;
+    std::atomic<uint64_t> failed_allocation_count;
+    std::atomic<uint64_t> soft_limit_collections;
+
+    // all collections, reported by the runtime
+    std::atomic<uint64_t> collection_count;
+    // collections requested explicitly, pause time is known only for them
+    std::atomic<uint64_t> timed_collection_count;
+    std::atomic<uint64_t> timed_collection_total_micros;
+    std::atomic<uint64_t> timed_collection_max_micros;
+    std::atomic<uint64_t> idle_collections;
+    std::atomic<uint64_t> idle_call_count;
+    std::atomic<uint64_t> idle_call_total_micros;
+    // engine-relative millis of the last top-level call end
+    std::atomic<uint64_t> last_activity_millis;
+
+    chakra_memory_stats(JsRuntimeHandle runtime_handle, uint64_t memory_limit_bytes, uint64_t soft_limit_bytes);
+
+    chakra_memory_stats(const chakra_memory_stats&) = delete;
+
+    chakra_memory_stats& operator=(const chakra_memory_stats&) = delete;
+
+    void set_thread(std::thread::id tid);
+
+    void record_collection(uint64_t micros);
+
+    void record_idle_call(uint64_t micros);
+
+    /**
+     * Collects counters and runtime memory usage, must be called
+     * under the registry lock so the runtime is not disposed concurrently
+     *
+     * @return stats snapshot
+     */
+    sl::json::value to_json();
+};
+
+/**
+ * Returns monotonic milliseconds, used for engine activity timestamps
+ *
+ * @return millis since unspecified epoch
+ */
+uint64_t monotonic_millis();
+
+/**
+ * Installs allocation and collection callbacks and adds engine to the process-wide registry
+ *
+ * @param stats engine counters
+ */
+void register_memory_stats(std::shared_ptr<chakra_memory_stats> stats);
+
+/**
+ * Removes engine from the registry, must be called before runtime is disposed
+ *
+ * @param stats engine counters
+ */
+void unregister_memory_stats(const std::shared_ptr<chakra_memory_stats>& stats) STATICLIB_NOEXCEPT;
+
+/**
+ * Returns stats of all live engines
+ *
+ * @return JSON array
+ */
+sl::json::value memory_stats_snapshot();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_MEMORY_HPP */
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_native_registry.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:35 PM
+ */
+
+#include "chakra_native_registry.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex registry_mutex;
+std::shared_ptr<chakra_native_registry> registry_instance;
+
+// installed after the built-ins, so these names would replace them in all engines
+bool is_reserved_name(const std::string& name) {
+    return 0 == name.compare(0, 7, "WILTON_") ||
+            "print" == name ||
+            "setTimeout" == name ||
+            "clearTimeout" == name ||
+            "setImmediate" == name ||
+            "clearImmediate" == name;
+}
+
+} // namespace
+
+void chakra_native_registry::add(std::shared_ptr<const chakra_native_function> fun) {
+    if (is_reserved_name(fun->name)) throw support::exception(TRACEMSG(
+            "Native function name is reserved for engine built-ins, name: [" + fun->name + "]"));
+    std::lock_guard<std::mutex> guard{mutex};
+    for (auto& fu : functions) {
+        if (fun->name == fu->name) throw support::exception(TRACEMSG(
+                "Native function is already registered, name: [" + fun->name + "]"));
+    }
+    wilton::support::log_info("wilton.engine.chakra.native", "Registering native function, name: [" + fun->name + "]");
+    functions.emplace_back(std::move(fun));
+    functions_count.store(functions.size(), std::memory_order_release);
+}
+
+std::vector<std::shared_ptr<const chakra_native_function>> chakra_native_registry::list(size_t from) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto res = std::vector<std::shared_ptr<const chakra_native_function>>();
+    for (size_t i = from; i < functions.size(); i++) {
+        res.push_back(functions[i]);
+    }
+    return res;
+}
+
+chakra_native_registry& native_registry() {
+    std::lock_guard<std::mutex> guard{registry_mutex};
+    if (nullptr == registry_instance.get()) {
+        registry_instance = std::make_shared<chakra_native_registry>();
+    }
+    return *registry_instance;
+}
+
+} // namespace
+}
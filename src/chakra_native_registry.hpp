@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_native_registry.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:25 PM
+ */
+
+#ifndef WILTON_CHAKRA_NATIVE_REGISTRY_HPP
+#define WILTON_CHAKRA_NATIVE_REGISTRY_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "wilton/wilton_chakra.h"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+struct chakra_native_function {
+    const std::string name;
+    void* const ctx;
+    const wilton_chakra_native_function fun;
+
+    chakra_native_function(const std::string& function_name, void* function_ctx,
+            wilton_chakra_native_function function_cb) :
+    name(function_name.data(), function_name.length()),
+    ctx(function_ctx),
+    fun(function_cb) { }
+
+    chakra_native_function(const chakra_native_function&) = delete;
+
+    chakra_native_function& operator=(const chakra_native_function&) = delete;
+};
+
+/**
+ * Functions registered by other modules, list is append-only,
+ * so engines install only the entries added since their last check
+ */
+class chakra_native_registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<const chakra_native_function>> functions;
+    std::atomic<size_t> functions_count;
+
+public:
+    chakra_native_registry() :
+    functions_count(0) { }
+
+    chakra_native_registry(const chakra_native_registry&) = delete;
+
+    chakra_native_registry& operator=(const chakra_native_registry&) = delete;
+
+    void add(std::shared_ptr<const chakra_native_function> fun);
+
+    // checked by engines on every top-level call
+    size_t count() const {
+        return functions_count.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Returns functions added after the specified number of entries
+     *
+     * @param from number of entries already seen by the caller
+     * @return new entries
+     */
+    std::vector<std::shared_ptr<const chakra_native_function>> list(size_t from);
+};
+
+chakra_native_registry& native_registry();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_NATIVE_REGISTRY_HPP */
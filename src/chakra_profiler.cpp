@@ -0,0 +1,243 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_profiler.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:40 AM
+ */
+
+#include "chakra_profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.profiler");
+
+const std::string dropped_stack = std::string("[dropped]");
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex profiler_mutex;
+std::shared_ptr<chakra_profiler> profiler_instance;
+
+void add_stacks(std::map<std::string, uint64_t>& dest, const std::map<std::string, uint64_t>& src) {
+    for (auto& en : src) {
+        dest[en.first] += en.second;
+    }
+}
+
+} // namespace
+
+void chakra_profile_shard::record(const std::string& stack, uint32_t max_stacks) {
+    std::lock_guard<std::mutex> guard{mutex};
+    samples += 1;
+    auto it = stacks.find(stack);
+    if (stacks.end() != it) {
+        it->second += 1;
+    } else if (stacks.size() < max_stacks) {
+        stacks.insert(std::make_pair(stack, 1));
+    } else {
+        dropped += 1;
+    }
+}
+
+void chakra_profile_shard::export_into(std::map<std::string, uint64_t>& dest, uint64_t& samples_dest,
+        uint64_t& dropped_dest, bool reset) {
+    std::lock_guard<std::mutex> guard{mutex};
+    for (auto& en : stacks) {
+        dest[en.first] += en.second;
+    }
+    samples_dest += samples;
+    dropped_dest += dropped;
+    if (reset) {
+        stacks.clear();
+        samples = 0;
+        dropped = 0;
+    }
+}
+
+chakra_profiler::chakra_profiler() :
+enabled_flag(false),
+profiler_generation(0),
+max_stacks_count(16384) {
+    this->worker = std::thread([this] {
+        this->run();
+    });
+}
+
+chakra_profiler::~chakra_profiler() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+void chakra_profiler::start(uint32_t interval, uint32_t max_stacks) {
+#ifdef WILTON_CHAKRA_CHAKRACORE
+    if (0 == interval) throw support::exception(TRACEMSG(
+            "Invalid sampling interval: [" + sl::support::to_string(interval) + "]"));
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        this->interval_millis = interval;
+        max_stacks_count.store(max_stacks, std::memory_order_relaxed);
+        enabled_flag.store(true, std::memory_order_release);
+        profiler_generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    cv.notify_all();
+    wilton::support::log_info(logger, "Profiler started, interval millis: [" +
+            sl::support::to_string(interval) + "], max stacks: [" + sl::support::to_string(max_stacks) + "]");
+#else // !WILTON_CHAKRA_CHAKRACORE
+    (void) interval;
+    (void) max_stacks;
+    throw support::exception(TRACEMSG("Profiler is supported only with ChakraCore"));
+#endif // WILTON_CHAKRA_CHAKRACORE
+}
+
+void chakra_profiler::stop() {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        enabled_flag.store(false, std::memory_order_release);
+        profiler_generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    cv.notify_all();
+    wilton::support::log_info(logger, "Profiler stopped");
+}
+
+void chakra_profiler::register_shard(std::shared_ptr<chakra_profile_shard> shard) {
+    std::lock_guard<std::mutex> guard{mutex};
+    shards.emplace_back(std::move(shard));
+}
+
+void chakra_profiler::unregister_shard(std::shared_ptr<chakra_profile_shard> shard) {
+    // taken under the lock, so no break is requested
+    // in the runtime after this call returns
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = std::find(shards.begin(), shards.end(), shard);
+    if (shards.end() == it) {
+        return;
+    }
+    shard->export_into(retired, retired_samples, retired_dropped, true);
+    shards.erase(it);
+}
+
+std::string chakra_profiler::collapsed(bool reset) {
+    auto merged = std::map<std::string, uint64_t>();
+    uint64_t samples = 0;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        add_stacks(merged, retired);
+        samples += retired_samples;
+        dropped += retired_dropped;
+        if (reset) {
+            retired.clear();
+            retired_samples = 0;
+            retired_dropped = 0;
+        }
+        for (auto& sh : shards) {
+            sh->export_into(merged, samples, dropped, reset);
+        }
+    }
+    if (dropped > 0) {
+        merged[dropped_stack] += dropped;
+    }
+    auto res = std::string();
+    for (auto& en : merged) {
+        res += en.first;
+        res.push_back(' ');
+        res += sl::support::to_string(en.second);
+        res.push_back('\n');
+    }
+    return res;
+}
+
+sl::json::value chakra_profiler::stats() {
+    auto merged = std::map<std::string, uint64_t>();
+    uint64_t samples = 0;
+    uint64_t dropped = 0;
+    std::lock_guard<std::mutex> guard{mutex};
+    samples += retired_samples;
+    dropped += retired_dropped;
+    uint32_t in_debug_mode = 0;
+    for (auto& sh : shards) {
+        sh->export_into(merged, samples, dropped, false);
+        if (sh->debugging.load(std::memory_order_relaxed)) {
+            in_debug_mode += 1;
+        }
+    }
+    return {
+        { "enabled", enabled() },
+        { "intervalMillis", interval_millis },
+        { "maxStacks", max_stacks() },
+        { "engines", static_cast<uint32_t>(shards.size()) },
+        { "enginesInDebugMode", in_debug_mode },
+        { "breakRequests", break_requests },
+        { "samples", samples },
+        { "droppedSamples", dropped },
+        { "distinctStacks", static_cast<uint64_t>(merged.size()) }
+    };
+}
+
+void chakra_profiler::run() {
+    std::unique_lock<std::mutex> guard{mutex};
+    while (!stopping) {
+        if (!enabled()) {
+            // no wakeups while profiling is stopped
+            cv.wait(guard);
+            continue;
+        }
+        cv.wait_for(guard, std::chrono::milliseconds(interval_millis));
+        if (stopping || !enabled()) {
+            continue;
+        }
+#ifdef WILTON_CHAKRA_CHAKRACORE
+        for (auto& sh : shards) {
+            if (sh->debugging.load(std::memory_order_acquire) &&
+                    sh->running.load(std::memory_order_acquire)) {
+                // thread-safe, break happens on the engine thread
+                // at the next statement
+                JsDiagRequestAsyncBreak(sh->runtime);
+                break_requests += 1;
+            }
+        }
+#endif // WILTON_CHAKRA_CHAKRACORE
+    }
+}
+
+std::shared_ptr<chakra_profiler> shared_profiler() {
+    std::lock_guard<std::mutex> guard{profiler_mutex};
+    if (nullptr == profiler_instance.get()) {
+        profiler_instance = std::make_shared<chakra_profiler>();
+    }
+    return profiler_instance;
+}
+
+} // namespace
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_profiler.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:20 AM
+ */
+
+#ifndef WILTON_CHAKRA_PROFILER_HPP
+#define WILTON_CHAKRA_PROFILER_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_jsrt.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Samples collected from a single engine, written by the engine
+ * thread from the debugger callback
+ */
+class chakra_profile_shard {
+    std::mutex mutex;
+    // collapsed stack ("outer;inner;leaf") to sample count
+    std::unordered_map<std::string, uint64_t> stacks;
+    uint64_t samples = 0;
+    uint64_t dropped = 0;
+
+public:
+    const JsRuntimeHandle runtime;
+    // engine is in debug mode, so async breaks can be requested
+    std::atomic<bool> debugging;
+    // engine runs a top-level call, idle engines are not sampled
+    std::atomic<bool> running;
+
+    chakra_profile_shard(JsRuntimeHandle runtime_handle) :
+    runtime(runtime_handle),
+    debugging(false),
+    running(false) { }
+
+    chakra_profile_shard(const chakra_profile_shard&) = delete;
+
+    chakra_profile_shard& operator=(const chakra_profile_shard&) = delete;
+
+    /**
+     * Records a single sample, new stacks are dropped
+     * after the number of distinct stacks reaches the limit
+     *
+     * @param stack collapsed stack
+     * @param max_stacks distinct stacks limit
+     */
+    void record(const std::string& stack, uint32_t max_stacks);
+
+    void export_into(std::map<std::string, uint64_t>& dest, uint64_t& samples_dest,
+            uint64_t& dropped_dest, bool reset);
+};
+
+/**
+ * Sampling profiler, single thread periodically requests an async break
+ * in every engine that is running JS, engine records its stack
+ * from the debugger callback and resumes; engines enter the debug
+ * mode only while profiling is started
+ */
+class chakra_profiler {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<chakra_profile_shard>> shards;
+    // samples from destroyed engines
+    std::map<std::string, uint64_t> retired;
+    uint64_t retired_samples = 0;
+    uint64_t retired_dropped = 0;
+    uint32_t interval_millis = 10;
+    uint64_t break_requests = 0;
+    bool stopping = false;
+    std::thread worker;
+
+    // checked by engines on every top-level call
+    std::atomic<bool> enabled_flag;
+    std::atomic<uint64_t> profiler_generation;
+    std::atomic<uint32_t> max_stacks_count;
+
+public:
+    chakra_profiler();
+
+    ~chakra_profiler() STATICLIB_NOEXCEPT;
+
+    chakra_profiler(const chakra_profiler&) = delete;
+
+    chakra_profiler& operator=(const chakra_profiler&) = delete;
+
+    /**
+     * Starts sampling, engines switch to the debug mode on their next call
+     *
+     * @param interval_millis sampling interval
+     * @param max_stacks distinct stacks limit per engine
+     */
+    void start(uint32_t interval_millis, uint32_t max_stacks);
+
+    /**
+     * Stops sampling, engines leave the debug mode on their next call,
+     * collected samples are kept
+     */
+    void stop();
+
+    bool enabled() const {
+        return enabled_flag.load(std::memory_order_acquire);
+    }
+
+    // changed on every start and stop
+    uint64_t generation() const {
+        return profiler_generation.load(std::memory_order_acquire);
+    }
+
+    uint32_t max_stacks() const {
+        return max_stacks_count.load(std::memory_order_relaxed);
+    }
+
+    void register_shard(std::shared_ptr<chakra_profile_shard> shard);
+
+    /**
+     * Removes shard, must be called before the runtime is disposed,
+     * its samples are kept in the process totals
+     */
+    void unregister_shard(std::shared_ptr<chakra_profile_shard> shard);
+
+    /**
+     * Returns samples from all engines in collapsed-stack format,
+     * one "frame;frame;frame count" line per stack
+     *
+     * @param reset clear collected samples
+     * @return collapsed stacks
+     */
+    std::string collapsed(bool reset);
+
+    sl::json::value stats();
+
+private:
+    void run();
+};
+
+std::shared_ptr<chakra_profiler> shared_profiler();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_PROFILER_HPP */
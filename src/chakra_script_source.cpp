@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_script_source.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 4:30 PM
+ */
+
+#include "chakra_script_source.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+#include "staticlib/utils.hpp"
+
+#include "wilton/wilton.h"
+#include "wilton/wilton_loader.h"
+
+#include "chakra_bytecode_cache.hpp"
+#include "chakra_mapped_file.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string file_prefix = std::string("file://");
+
+struct source_entry {
+    std::shared_ptr<chakra_script_source> source;
+    // not set for non-file URLs
+    chakra_file_stamp stamp;
+};
+
+// sources are shared by all engines in the process
+std::mutex sources_mutex;
+std::unordered_map<std::string, source_entry> sources;
+
+std::shared_ptr<chakra_script_source> open_source(const std::string& url) {
+    char* code = nullptr;
+    int code_len = 0;
+    auto err_load = wilton_load_resource(url.c_str(), static_cast<int>(url.length()),
+            std::addressof(code), std::addressof(code_len));
+    if (nullptr != err_load) {
+        support::throw_wilton_error(err_load, TRACEMSG(err_load));
+    }
+    return std::make_shared<chakra_script_source>(code, code_len);
+}
+
+} // namespace
+
+chakra_script_source::chakra_script_source(char* loaded_data, int loaded_data_len) :
+loaded(loaded_data),
+loaded_len(loaded_data_len) {
+    this->source_hash = chakra_bytecode_cache::hash(data());
+}
+
+chakra_script_source::chakra_script_source(std::string&& code) :
+owned(std::move(code)) {
+    this->source_hash = chakra_bytecode_cache::hash(data());
+}
+
+chakra_script_source::~chakra_script_source() STATICLIB_NOEXCEPT {
+    if (nullptr != loaded) {
+        wilton_free(loaded);
+    }
+}
+
+std::shared_ptr<chakra_script_source> load_script_source(const std::string& url) {
+    // file is checked outside of the lock, stamp is taken before
+    // loading, so a change made during the load causes one extra reload
+    auto stamp = chakra_file_stamp();
+    if (sl::utils::starts_with(url, file_prefix)) {
+        stamp = read_file_stamp(url.substr(file_prefix.length()));
+    }
+    {
+        std::lock_guard<std::mutex> guard{sources_mutex};
+        auto it = sources.find(url);
+        if (sources.end() != it && it->second.stamp.same_as(stamp)) {
+            return it->second.source;
+        }
+    }
+    // loading is done outside of the lock, concurrent
+    // first loads of the same module may both succeed
+    auto en = source_entry();
+    en.source = open_source(url);
+    en.stamp = stamp;
+    std::lock_guard<std::mutex> guard{sources_mutex};
+    auto it = sources.find(url);
+    if (sources.end() != it) {
+        if (it->second.stamp.same_as(stamp)) {
+            return it->second.source;
+        }
+        // engines that already use the previous version keep it alive
+        it->second = en;
+    } else {
+        sources.insert(std::make_pair(url, en));
+    }
+    return en.source;
+}
+
+} // namespace
+}
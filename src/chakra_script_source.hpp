@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_script_source.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 4:20 PM
+ */
+
+#ifndef WILTON_CHAKRA_SCRIPT_SOURCE_HPP
+#define WILTON_CHAKRA_SCRIPT_SOURCE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "staticlib/io.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Immutable module source shared by all engines, backed either
+ * by a buffer returned from the resource loader or by an owned string;
+ * sources are never mapped from disk, engine reads them again for deferred
+ * parsing and stack traces, so they must not change under running engines
+ */
+class chakra_script_source {
+    // allocated by wilton_load_resource
+    char* loaded = nullptr;
+    int loaded_len = 0;
+    std::string owned;
+    uint64_t source_hash = 0;
+
+public:
+    chakra_script_source(char* loaded_data, int loaded_data_len);
+
+    chakra_script_source(std::string&& code);
+
+    ~chakra_script_source() STATICLIB_NOEXCEPT;
+
+    chakra_script_source(const chakra_script_source&) = delete;
+
+    chakra_script_source& operator=(const chakra_script_source&) = delete;
+
+    sl::io::span<const char> data() const {
+        if (nullptr != loaded) {
+            return {const_cast<const char*>(loaded), loaded_len};
+        }
+        return {owned.data(), owned.length()};
+    }
+
+    /**
+     * Hash of the source data, computed once when the source is created
+     *
+     * @return source hash
+     */
+    uint64_t hash() const {
+        return source_hash;
+    }
+};
+
+/**
+ * Loads module source, sources are loaded once per process and one copy
+ * is shared by all engines; "file://" sources are reloaded when the file
+ * size or last write time changes, engines that already use the previous
+ * version keep it; other URLs point into the application bundle, that
+ * does not change while the process is running, so they are loaded once
+ * and kept until exit
+ *
+ * @param url module URL as passed to wilton_load_resource
+ * @return module source
+ */
+std::shared_ptr<chakra_script_source> load_script_source(const std::string& url);
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_SCRIPT_SOURCE_HPP */
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_shared_store.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 9:55 PM
+ */
+
+#include "chakra_shared_store.hpp"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.store");
+
+const std::string no_path = std::string();
+
+// includes replaced blobs still referenced by engines
+std::atomic<uint64_t> live_blobs(0);
+std::atomic<uint64_t> live_bytes(0);
+
+std::mutex store_mutex;
+std::shared_ptr<chakra_shared_store> store_instance;
+
+} // namespace
+
+chakra_shared_blob::chakra_shared_blob(std::vector<char>&& data, uint64_t version) :
+owned(std::move(data)),
+span(owned.data(), owned.size()),
+blob_version(version) {
+    live_blobs.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_add(span.size(), std::memory_order_relaxed);
+}
+
+chakra_shared_blob::chakra_shared_blob(std::shared_ptr<chakra_mapped_file> mapped_file, uint64_t version) :
+file(std::move(mapped_file)),
+span(file->data()),
+blob_version(version) {
+    live_blobs.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_add(span.size(), std::memory_order_relaxed);
+}
+
+chakra_shared_blob::~chakra_shared_blob() STATICLIB_NOEXCEPT {
+    live_blobs.fetch_sub(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub(span.size(), std::memory_order_relaxed);
+}
+
+const std::string& chakra_shared_blob::file_path() const {
+    return nullptr != file.get() ? file->file_path() : no_path;
+}
+
+chakra_shared_store::chakra_shared_store() :
+store_generation(0) { }
+
+uint64_t chakra_shared_store::publish(const std::string& name, std::vector<char>&& data) {
+    auto version = uint64_t(0);
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        version = next_version++;
+    }
+    auto blob = std::make_shared<const chakra_shared_blob>(std::move(data), version);
+    return put(name, std::move(blob));
+}
+
+uint64_t chakra_shared_store::publish_file(const std::string& name, const std::string& path) {
+    // exposed to JS as a writable ArrayBuffer, writes to
+    // read-only pages would crash the process
+    auto file = std::make_shared<chakra_mapped_file>(path, true);
+    auto version = uint64_t(0);
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        version = next_version++;
+    }
+    auto blob = std::make_shared<const chakra_shared_blob>(std::move(file), version);
+    return put(name, std::move(blob));
+}
+
+bool chakra_shared_store::remove(const std::string& name) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto removed = entries.erase(name) > 0;
+    if (removed) {
+        store_generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return removed;
+}
+
+std::shared_ptr<const chakra_shared_blob> chakra_shared_store::get(const std::string& name) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = entries.find(name);
+    if (entries.end() == it) {
+        return std::shared_ptr<const chakra_shared_blob>();
+    }
+    return it->second;
+}
+
+sl::json::value chakra_shared_store::stats() {
+    auto list = std::vector<sl::json::field>();
+    uint64_t bytes = 0;
+    uint64_t publishes = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (auto& en : entries) {
+            auto& blob = *en.second;
+            bytes += blob.data().size();
+            list.emplace_back(en.first, sl::json::value({
+                { "version", blob.version() },
+                { "size", static_cast<uint64_t>(blob.data().size()) },
+                { "file", blob.file_path() }
+            }));
+        }
+        publishes = publish_count;
+    }
+    return {
+        { "entries", std::move(list) },
+        { "publishedBytes", bytes },
+        { "publishCount", publishes },
+        { "liveBlobs", live_blobs.load(std::memory_order_relaxed) },
+        { "liveBytes", live_bytes.load(std::memory_order_relaxed) }
+    };
+}
+
+uint64_t chakra_shared_store::put(const std::string& name, std::shared_ptr<const chakra_shared_blob> blob) {
+    auto version = blob->version();
+    auto size = blob->data().size();
+    // previous blob is released outside of the lock
+    auto prev = std::shared_ptr<const chakra_shared_blob>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(name);
+        if (entries.end() != it) {
+            if (it->second->version() > version) {
+                // concurrent publish of the same name completed first
+                return it->second->version();
+            }
+            prev = std::move(it->second);
+            it->second = std::move(blob);
+        } else {
+            entries.insert(std::make_pair(name, std::move(blob)));
+        }
+        publish_count += 1;
+        store_generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    wilton::support::log_debug(logger, "Blob published, name: [" + name + "]," +
+            " version: [" + sl::support::to_string(version) + "]," +
+            " size: [" + sl::support::to_string(size) + "]");
+    return version;
+}
+
+chakra_shared_store& shared_store() {
+    std::lock_guard<std::mutex> guard{store_mutex};
+    if (nullptr == store_instance.get()) {
+        store_instance = std::make_shared<chakra_shared_store>();
+    }
+    return *store_instance;
+}
+
+} // namespace
+}
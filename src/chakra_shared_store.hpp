@@ -0,0 +1,150 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * File:   chakra_shared_store.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 9:40 PM
+ */
+
+#ifndef WILTON_CHAKRA_SHARED_STORE_HPP
+#define WILTON_CHAKRA_SHARED_STORE_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_mapped_file.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Immutable binary blob, either owned or memory-mapped from file,
+ * the same memory is exposed to all engines as external ArrayBuffers
+ */
+class chakra_shared_blob {
+    std::vector<char> owned;
+    std::shared_ptr<chakra_mapped_file> file;
+    sl::io::span<const char> span;
+    uint64_t blob_version;
+
+public:
+    chakra_shared_blob(std::vector<char>&& data, uint64_t version);
+
+    chakra_shared_blob(std::shared_ptr<chakra_mapped_file> mapped_file, uint64_t version);
+
+    ~chakra_shared_blob() STATICLIB_NOEXCEPT;
+
+    chakra_shared_blob(const chakra_shared_blob&) = delete;
+
+    chakra_shared_blob& operator=(const chakra_shared_blob&) = delete;
+
+    sl::io::span<const char> data() const {
+        return span;
+    }
+
+    uint64_t version() const {
+        return blob_version;
+    }
+
+    // empty for in-memory blobs
+    const std::string& file_path() const;
+};
+
+/**
+ * Named blobs shared by all engines of the process, publishing a name
+ * again atomically replaces its blob; replaced blobs stay alive
+ * while engines still reference them.
+ *
+ * Blobs are immutable by contract: all engines get ArrayBuffers over
+ * the same memory, so writes from JS are not synchronized with readers
+ * on other threads and their results are unspecified. Writes cannot
+ * crash the process, file-backed blobs are mapped copy-on-write and
+ * are never written back to the file. To change a blob, publish a new
+ * version under the same name.
+ */
+class chakra_shared_store {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const chakra_shared_blob>> entries;
+    uint64_t next_version = 1;
+    uint64_t publish_count = 0;
+    // bumped on every change, lets engines reuse their
+    // cached buffers without taking the mutex
+    std::atomic<uint64_t> store_generation;
+
+public:
+    chakra_shared_store();
+
+    chakra_shared_store(const chakra_shared_store&) = delete;
+
+    chakra_shared_store& operator=(const chakra_shared_store&) = delete;
+
+    /**
+     * Publishes blob under the specified name
+     *
+     * @param name blob name
+     * @param data blob contents
+     * @return version of the published blob, unique within the process
+     */
+    uint64_t publish(const std::string& name, std::vector<char>&& data);
+
+    /**
+     * Publishes memory-mapped file contents under the specified name
+     *
+     * @param name blob name
+     * @param path file path
+     * @return version of the published blob, unique within the process
+     */
+    uint64_t publish_file(const std::string& name, const std::string& path);
+
+    bool remove(const std::string& name);
+
+    /**
+     * Returns current blob for the specified name
+     *
+     * @param name blob name
+     * @return blob or empty pointer if name is not published
+     */
+    std::shared_ptr<const chakra_shared_blob> get(const std::string& name);
+
+    uint64_t generation() const {
+        return store_generation.load(std::memory_order_acquire);
+    }
+
+    sl::json::value stats();
+
+private:
+    uint64_t put(const std::string& name, std::shared_ptr<const chakra_shared_blob> blob);
+};
+
+chakra_shared_store& shared_store();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_SHARED_STORE_HPP */
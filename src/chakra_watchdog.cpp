@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_watchdog.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 9:50 PM
+ */
+
+#include "chakra_watchdog.hpp"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace chakra {
+
+namespace { // anonymous
+
+const std::string logger = std::string("wilton.engine.chakra.watchdog");
+
+// function-local statics initialization
+// is not thread-safe on msvc 2013
+std::mutex watchdog_mutex;
+std::shared_ptr<chakra_watchdog> watchdog_instance;
+
+} // namespace
+
+chakra_watchdog::chakra_watchdog() {
+    wilton::support::log_info(logger, "Starting call watchdog thread");
+    this->worker = std::thread([this] {
+        this->run();
+    });
+}
+
+chakra_watchdog::~chakra_watchdog() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+uint64_t chakra_watchdog::arm(JsRuntimeHandle runtime, uint32_t timeout_millis) {
+    auto en = entry();
+    en.runtime = runtime;
+    en.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_millis);
+    en.fired = false;
+    uint64_t token = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        token = next_token;
+        next_token += 1;
+        entries.insert(std::make_pair(token, en));
+    }
+    cv.notify_one();
+    return token;
+}
+
+bool chakra_watchdog::disarm(uint64_t token) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = entries.find(token);
+    if (entries.end() == it) {
+        return false;
+    }
+    auto fired = it->second.fired;
+    entries.erase(it);
+    return fired;
+}
+
+bool chakra_watchdog::fired(uint64_t token) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = entries.find(token);
+    return entries.end() != it && it->second.fired;
+}
+
+void chakra_watchdog::run() {
+    std::unique_lock<std::mutex> guard{mutex};
+    while (!stopping) {
+        auto now = std::chrono::steady_clock::now();
+        auto has_wake = false;
+        auto wake = std::chrono::steady_clock::time_point();
+        for (auto& pa : entries) {
+            auto& en = pa.second;
+            if (en.fired) {
+                continue;
+            }
+            if (en.deadline <= now) {
+                // done under the lock, so runtime cannot be disarmed
+                // and re-enabled between the check and the call
+                auto err = JsDisableRuntimeExecution(en.runtime);
+                en.fired = true;
+                if (JsNoError != err) {
+                    wilton::support::log_error(logger, std::string() + "'JsDisableRuntimeExecution' error," +
+                            " code: [" + sl::support::to_string(err) + "]");
+                }
+            } else if (!has_wake || en.deadline < wake) {
+                wake = en.deadline;
+                has_wake = true;
+            }
+        }
+        if (has_wake) {
+            cv.wait_until(guard, wake);
+        } else {
+            cv.wait(guard);
+        }
+    }
+}
+
+std::shared_ptr<chakra_watchdog> shared_watchdog() {
+    std::lock_guard<std::mutex> guard{watchdog_mutex};
+    if (nullptr == watchdog_instance.get()) {
+        watchdog_instance = std::make_shared<chakra_watchdog>();
+    }
+    return watchdog_instance;
+}
+
+} // namespace
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   chakra_watchdog.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 9:40 PM
+ */
+
+#ifndef WILTON_CHAKRA_WATCHDOG_HPP
+#define WILTON_CHAKRA_WATCHDOG_HPP
+
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "wilton/support/exception.hpp"
+
+#include "chakra_jsrt.hpp"
+
+namespace wilton {
+namespace chakra {
+
+/**
+ * Single thread that interrupts script execution in runtimes whose
+ * call deadline has expired, runtime must be created with
+ * 'JsRuntimeAttributeAllowScriptInterrupt'
+ */
+class chakra_watchdog {
+    struct entry {
+        JsRuntimeHandle runtime;
+        std::chrono::steady_clock::time_point deadline;
+        bool fired;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::unordered_map<uint64_t, entry> entries;
+    uint64_t next_token = 1;
+    bool stopping = false;
+    std::thread worker;
+
+public:
+    chakra_watchdog();
+
+    ~chakra_watchdog() STATICLIB_NOEXCEPT;
+
+    chakra_watchdog(const chakra_watchdog&) = delete;
+
+    chakra_watchdog& operator=(const chakra_watchdog&) = delete;
+
+    /**
+     * Starts watching the runtime
+     *
+     * @param runtime runtime to interrupt
+     * @param timeout_millis time after which execution is disabled
+     * @return token to pass to 'disarm'
+     */
+    uint64_t arm(JsRuntimeHandle runtime, uint32_t timeout_millis);
+
+    /**
+     * Stops watching the runtime, execution is not re-enabled here
+     *
+     * @param token token returned from 'arm'
+     * @return true if execution was disabled by the watchdog
+     */
+    bool disarm(uint64_t token);
+
+    /**
+     * Checks whether execution was disabled, runtime stays watched
+     *
+     * @param token token returned from 'arm'
+     * @return true if execution was disabled by the watchdog
+     */
+    bool fired(uint64_t token);
+
+private:
+    void run();
+};
+
+/**
+ * Returns process-wide watchdog, watchdog is created on first use
+ *
+ * @return watchdog
+ */
+std::shared_ptr<chakra_watchdog> shared_watchdog();
+
+} // namespace
+}
+
+#endif /* WILTON_CHAKRA_WATCHDOG_HPP */
@@ -20,44 +20,329 @@
  *
  * Created on January 30, 2018, 2:10 PM
  */
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "staticlib/config.hpp"
 #include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
 
 #include "wilton/wilton.h"
+#include "wilton/wilton_chakra.h"
+#include "wilton/wilton_loader.h"
 
 #include "wilton/support/buffer.hpp"
 #include "wilton/support/exception.hpp"
 #include "wilton/support/registrar.hpp"
-#include "wilton/support/script_engine_map.hpp"
 
+#include "chakra_batch.hpp"
+#include "chakra_callstats.hpp"
+#include "chakra_channels.hpp"
+#include "chakra_config.hpp"
 #include "chakra_engine.hpp"
+#include "chakra_engine_map.hpp"
+#include "chakra_engine_pool.hpp"
+#include "chakra_engine_recycler.hpp"
+#include "chakra_gc_scheduler.hpp"
+#include "chakra_log_sink.hpp"
+#include "chakra_memory.hpp"
+#include "chakra_native_registry.hpp"
+#include "chakra_profiler.hpp"
+#include "chakra_shared_store.hpp"
 
 namespace wilton {
 namespace chakra {
 
-// initialized from wilton_module_init
-std::shared_ptr<support::script_engine_map<chakra_engine>> shared_tlmap() {
-    static auto tlmap = std::make_shared<support::script_engine_map<chakra_engine>>();
-    return tlmap;
+// set from wilton_module_init, one of them is used
+std::shared_ptr<chakra_engine_map> tlmap_instance;
+std::shared_ptr<chakra_engine_pool> pool_instance;
+// started only when idle GC or memory growth recycling is enabled
+std::shared_ptr<chakra_gc_scheduler> gc_scheduler_instance;
+
+// confirms memory growth for recycling when idle GC is disabled
+const uint32_t recycle_check_interval_millis = 1000;
+// set only when recycling is enabled
+std::shared_ptr<chakra_engine_recycler> recycler_instance;
+
+std::string load_init_code() {
+    char* conf = nullptr;
+    int conf_len = 0;
+    auto err_conf = wilton_config(std::addressof(conf), std::addressof(conf_len));
+    if (nullptr != err_conf) support::throw_wilton_error(err_conf, TRACEMSG(err_conf));
+    auto deferred_conf = sl::support::defer([conf] () STATICLIB_NOEXCEPT {
+        wilton_free(conf);
+    });
+    auto json = sl::json::load({const_cast<const char*>(conf), conf_len});
+    auto url = json["requireJs"]["baseUrl"].as_string_nonempty_or_throw("requireJs.baseUrl") +
+            "/wilton-requirejs/wilton-require.js";
+    char* code = nullptr;
+    int code_len = 0;
+    auto err_load = wilton_load_resource(url.c_str(), static_cast<int>(url.length()),
+            std::addressof(code), std::addressof(code_len));
+    if (nullptr != err_load) support::throw_wilton_error(err_load, TRACEMSG(err_load));
+    auto deferred_code = sl::support::defer([code] () STATICLIB_NOEXCEPT {
+        wilton_free(code);
+    });
+    return std::string(code, static_cast<size_t>(code_len));
+}
+
+support::buffer run_with_engine(std::function<support::buffer(chakra_engine&)> fun) {
+    if (nullptr != pool_instance.get()) {
+        return pool_instance->run(std::move(fun));
+    }
+    return tlmap_instance->run(std::move(fun));
 }
 
 support::buffer runscript(sl::io::span<const char> data) {
-    auto tlmap = shared_tlmap();
-    return tlmap->run_script(data);
+    return run_with_engine([data](chakra_engine& engine) {
+        return engine.run_callback_script(data);
+    });
+}
+
+support::buffer runscript_context(sl::io::span<const char> data) {
+    // envelope: {"context": "name", "timeoutMillis": 1000, "callbackScript": {...}}
+    auto json = sl::json::load(data);
+    auto options = chakra_call_options();
+    auto callback_script = std::string();
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("context" == name) {
+            options.context = fi.as_string_or_throw(name);
+        } else if ("timeoutMillis" == name) {
+            options.timeout_millis = fi.as_uint32_or_throw(name);
+        } else if ("callbackScript" == name) {
+            callback_script = fi.val().dumps();
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (callback_script.empty()) throw support::exception(TRACEMSG(
+            "Required parameter 'callbackScript' not specified"));
+    auto span = sl::io::span<const char>(callback_script.data(), callback_script.length());
+    return run_with_engine([span, &options](chakra_engine& engine) {
+        return engine.run_callback_script_with_options(span, options);
+    });
+}
+
+support::buffer runscript_batch(sl::io::span<const char> data) {
+    // envelope: {"context": "name", "timeoutMillis": 1000, "callbackScripts": [{...}, ...]},
+    // callback scripts are not parsed, engine gets the text of the array from the input
+    auto options = chakra_call_options();
+    auto span = sl::io::span<const char>(nullptr, 0);
+    auto has_scripts = false;
+    for (auto& fi : split_json_object(data)) {
+        auto& name = fi.first;
+        if ("context" == name) {
+            options.context = sl::json::load(fi.second).as_string_or_throw(name);
+        } else if ("timeoutMillis" == name) {
+            options.timeout_millis = sl::json::load(fi.second).as_uint32_or_throw(name);
+        } else if ("callbackScripts" == name) {
+            span = fi.second;
+            has_scripts = true;
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (!has_scripts) throw support::exception(TRACEMSG(
+            "Required parameter 'callbackScripts' not specified"));
+    return run_with_engine([span, &options](chakra_engine& engine) {
+        return engine.run_callback_script_batch(span, options);
+    });
 }
 
 support::buffer rungc(sl::io::span<const char>) {
-    auto tlmap = shared_tlmap();
-    tlmap->run_garbage_collector();
-    return support::make_null_buffer();
+    return run_with_engine([](chakra_engine& engine) {
+        engine.run_garbage_collector();
+        return support::make_null_buffer();
+    });
+}
+
+support::buffer runeventloop(sl::io::span<const char> data) {
+    // optional input: {"timeoutMillis": 100}
+    uint32_t timeout = 0;
+    if (data.size() > 0) {
+        auto json = sl::json::load(data);
+        for (const sl::json::field& fi : json.as_object()) {
+            auto& name = fi.name();
+            if ("timeoutMillis" == name) {
+                timeout = fi.as_uint32_or_throw(name);
+            } else {
+                throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+            }
+        }
+    }
+    return run_with_engine([timeout](chakra_engine& engine) {
+        auto idle = engine.run_event_loop(timeout);
+        return support::make_json_buffer({
+            { "idle", idle }
+        });
+    });
+}
+
+support::buffer memstats(sl::io::span<const char>) {
+    return support::make_json_buffer({
+        { "engines", memory_stats_snapshot() }
+    });
+}
+
+support::buffer callstats(sl::io::span<const char>) {
+    return support::make_json_buffer(callstats_snapshot());
+}
+
+support::buffer poolstats(sl::io::span<const char>) {
+    if (nullptr == pool_instance.get()) {
+        return support::make_null_buffer();
+    }
+    return support::make_json_buffer(pool_instance->stats());
+}
+
+support::buffer sharedstore_publish(sl::io::span<const char> data) {
+    // {"name": "routes", "path": "/path/to/file"} or {"name": "routes", "data": "..."}
+    auto json = sl::json::load(data);
+    auto rname = std::string();
+    auto path = std::string();
+    auto contents = std::string();
+    auto has_contents = false;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("name" == name) {
+            rname = fi.as_string_nonempty_or_throw(name);
+        } else if ("path" == name) {
+            path = fi.as_string_nonempty_or_throw(name);
+        } else if ("data" == name) {
+            contents = fi.as_string_or_throw(name);
+            has_contents = true;
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (rname.empty()) throw support::exception(TRACEMSG(
+            "Required parameter 'name' not specified"));
+    if (path.empty() == !has_contents) throw support::exception(TRACEMSG(
+            "One of parameters 'path' or 'data' must be specified"));
+    auto version = uint64_t(0);
+    if (!path.empty()) {
+        version = shared_store().publish_file(rname, path);
+    } else {
+        version = shared_store().publish(rname, std::vector<char>(contents.begin(), contents.end()));
+    }
+    return support::make_json_buffer({
+        { "version", version }
+    });
+}
+
+support::buffer sharedstore_remove(sl::io::span<const char> data) {
+    auto json = sl::json::load(data);
+    auto rname = json["name"].as_string_nonempty_or_throw("name");
+    auto removed = shared_store().remove(rname);
+    return support::make_json_buffer({
+        { "removed", removed }
+    });
+}
+
+support::buffer sharedstore_stats(sl::io::span<const char>) {
+    return support::make_json_buffer(shared_store().stats());
+}
+
+support::buffer channel_post(sl::io::span<const char> data) {
+    // {"channel": "name", "message": {...}}, buffers cannot be transferred from native code
+    auto json = sl::json::load(data);
+    auto msg = chakra_message();
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("channel" == name) {
+            msg.channel = fi.as_string_nonempty_or_throw(name);
+        } else if ("message" == name) {
+            msg.data = fi.val().clone();
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (msg.channel.empty()) throw support::exception(TRACEMSG(
+            "Required parameter 'channel' not specified"));
+    auto accepted = channel_registry().post(msg);
+    return support::make_json_buffer({
+        { "accepted", accepted }
+    });
+}
+
+support::buffer channel_stats(sl::io::span<const char>) {
+    return support::make_json_buffer(channel_registry().stats());
+}
+
+support::buffer profile(sl::io::span<const char> data) {
+    // {"action": "start", "intervalMillis": 10, "maxStacks": 16384},
+    // {"action": "stop"}, {"action": "dump", "reset": true} or {"action": "stats"}
+    auto json = sl::json::load(data);
+    auto action = std::string();
+    uint32_t interval = 10;
+    uint32_t max_stacks = 16384;
+    auto reset = false;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("action" == name) {
+            action = fi.as_string_nonempty_or_throw(name);
+        } else if ("intervalMillis" == name) {
+            interval = fi.as_uint32_positive_or_throw(name);
+        } else if ("maxStacks" == name) {
+            max_stacks = fi.as_uint32_positive_or_throw(name);
+        } else if ("reset" == name) {
+            reset = fi.as_bool_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    auto profiler = shared_profiler();
+    if ("start" == action) {
+        profiler->start(interval, max_stacks);
+        return support::make_null_buffer();
+    } else if ("stop" == action) {
+        profiler->stop();
+        return support::make_null_buffer();
+    } else if ("dump" == action) {
+        // collapsed stacks, input for flamegraph.pl and similar tools
+        return support::make_string_buffer(profiler->collapsed(reset));
+    } else if ("stats" == action) {
+        return support::make_json_buffer(profiler->stats());
+    }
+    throw support::exception(TRACEMSG("Invalid 'action' specified: [" + action + "]," +
+            " supported actions: [start, stop, dump, stats]"));
+}
+
+support::buffer recyclestats(sl::io::span<const char>) {
+    if (nullptr == recycler_instance.get()) {
+        return support::make_null_buffer();
+    }
+    return support::make_json_buffer(recycler_instance->stats());
+}
+
+support::buffer logsinkstats(sl::io::span<const char>) {
+    auto stats = log_sink_stats();
+    if (sl::json::type::nullt == stats.json_type()) {
+        return support::make_null_buffer();
+    }
+    return support::make_json_buffer(stats);
+}
+
+void run_idle_collections(uint32_t min_idle_millis, uint64_t min_growth_bytes) {
+    auto fun = [min_idle_millis, min_growth_bytes](chakra_engine& engine) {
+        engine.run_idle_collection(min_idle_millis, min_growth_bytes);
+    };
+    if (nullptr != pool_instance.get()) {
+        pool_instance->for_each_idle_engine(fun);
+    } else {
+        tlmap_instance->for_each_idle_engine(fun);
+    }
 }
 
 void clean_tls(void*, const char* thread_id, int thread_id_len) {
-    auto tlmap = shared_tlmap();
-    tlmap->clean_thread_local(thread_id, thread_id_len);
+    if (nullptr != tlmap_instance.get()) {
+        tlmap_instance->clean_thread_local(thread_id, thread_id_len);
+    }
 }
 
 } // namespace
@@ -65,11 +350,74 @@ void clean_tls(void*, const char* thread_id, int thread_id_len) {
 
 extern "C" char* wilton_module_init() {
     try {
-        wilton::chakra::shared_tlmap();
+        auto cfg = wilton::chakra::get_config();
+        auto init_code = wilton::chakra::load_init_code();
+        auto policy = wilton::chakra::chakra_recycle_policy();
+        policy.max_calls = cfg.recycle_after_calls;
+        policy.max_memory_growth_bytes = cfg.recycle_memory_growth_bytes;
+        policy.max_age_millis = cfg.recycle_max_age_millis;
+        if (policy.enabled()) {
+            wilton::chakra::recycler_instance = std::make_shared<wilton::chakra::chakra_engine_recycler>(
+                    policy, std::string(init_code.data(), init_code.length()));
+        }
+        if (cfg.engine_pool_size > 0) {
+            wilton::chakra::pool_instance = std::make_shared<wilton::chakra::chakra_engine_pool>(
+                    std::move(init_code), cfg.engine_pool_size,
+                    cfg.engine_pool_borrow_timeout_millis, cfg.engine_pool_max_waiters,
+                    wilton::chakra::recycler_instance);
+        } else {
+            wilton::chakra::tlmap_instance = std::make_shared<wilton::chakra::chakra_engine_map>(
+                    std::move(init_code), wilton::chakra::recycler_instance);
+        }
+        if (cfg.idle_gc_interval_millis > 0) {
+            auto min_idle = cfg.idle_gc_min_idle_millis;
+            auto min_growth = cfg.idle_gc_min_growth_bytes;
+            wilton::chakra::gc_scheduler_instance = std::make_shared<wilton::chakra::chakra_gc_scheduler>(
+                    cfg.idle_gc_interval_millis, [min_idle, min_growth] {
+                        wilton::chakra::run_idle_collections(min_idle, min_growth);
+                    });
+        } else if (policy.max_memory_growth_bytes > 0) {
+            // only collections requested by recycling checks are done
+            wilton::chakra::gc_scheduler_instance = std::make_shared<wilton::chakra::chakra_gc_scheduler>(
+                    wilton::chakra::recycle_check_interval_millis, [] {
+                        wilton::chakra::run_idle_collections((std::numeric_limits<uint32_t>::max)(),
+                                (std::numeric_limits<uint64_t>::max)());
+                    });
+        }
         auto err = wilton_register_tls_cleaner(nullptr, wilton::chakra::clean_tls);
         if (nullptr != err) wilton::support::throw_wilton_error(err, TRACEMSG(err));
         wilton::support::register_wiltoncall("runscript_chakra", wilton::chakra::runscript);
+        wilton::support::register_wiltoncall("runscript_context_chakra", wilton::chakra::runscript_context);
+        wilton::support::register_wiltoncall("runscript_batch_chakra", wilton::chakra::runscript_batch);
         wilton::support::register_wiltoncall("rungc_chakra", wilton::chakra::rungc);
+        wilton::support::register_wiltoncall("memstats_chakra", wilton::chakra::memstats);
+        wilton::support::register_wiltoncall("runeventloop_chakra", wilton::chakra::runeventloop);
+        wilton::support::register_wiltoncall("poolstats_chakra", wilton::chakra::poolstats);
+        wilton::support::register_wiltoncall("callstats_chakra", wilton::chakra::callstats);
+        wilton::support::register_wiltoncall("sharedstore_publish_chakra", wilton::chakra::sharedstore_publish);
+        wilton::support::register_wiltoncall("sharedstore_remove_chakra", wilton::chakra::sharedstore_remove);
+        wilton::support::register_wiltoncall("sharedstore_stats_chakra", wilton::chakra::sharedstore_stats);
+        wilton::support::register_wiltoncall("profile_chakra", wilton::chakra::profile);
+        wilton::support::register_wiltoncall("recyclestats_chakra", wilton::chakra::recyclestats);
+        wilton::support::register_wiltoncall("logsinkstats_chakra", wilton::chakra::logsinkstats);
+        wilton::support::register_wiltoncall("channelpost_chakra", wilton::chakra::channel_post);
+        wilton::support::register_wiltoncall("channelstats_chakra", wilton::chakra::channel_stats);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+extern "C" char* wilton_chakra_register_function(const char* name, int name_len, void* function_ctx,
+        wilton_chakra_native_function function_cb) {
+    if (nullptr == name) return wilton::support::alloc_copy(TRACEMSG("Null 'name' parameter specified"));
+    if (name_len <= 0 || name_len > 0xffff) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'name_len' parameter specified: [" + sl::support::to_string(name_len) + "]"));
+    if (nullptr == function_cb) return wilton::support::alloc_copy(TRACEMSG("Null 'function_cb' parameter specified"));
+    try {
+        auto name_str = std::string(name, static_cast<size_t>(name_len));
+        wilton::chakra::native_registry().add(std::make_shared<const wilton::chakra::chakra_native_function>(
+                name_str, function_ctx, function_cb));
         return nullptr;
     } catch (const std::exception& e) {
         return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));